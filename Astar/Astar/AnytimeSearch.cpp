@@ -0,0 +1,189 @@
+#include "AnytimeSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+AnytimeSearch::AnytimeSearch(const Grid& grid)
+    : grid(grid), width(0), height(0), active(false), finished(false), start(0, 0), goal(0, 0),
+      startIndex(-1), goalIndex(-1), initialWeight(WEIGHT_SCALE), weightStep(WEIGHT_SCALE), weight(WEIGHT_SCALE),
+      pass(0), generation(0), version(0), bound(0.0), expanded(0), passExpanded(0), totalExpanded(0) {}
+
+void AnytimeSearch::plan(const Node& start, const Node& goal, double initialWeight, double weightStep) {
+    this->start = Node(start.x, start.y);
+    this->goal = Node(goal.x, goal.y);
+    int first = static_cast<int>(std::lround(initialWeight * WEIGHT_SCALE));
+    int step = static_cast<int>(std::lround(weightStep * WEIGHT_SCALE));
+    this->initialWeight = first > WEIGHT_SCALE ? first : WEIGHT_SCALE;
+    this->weightStep = step > 0 ? step : 1;
+    active = true;
+    totalExpanded = 0;
+    restart();
+}
+
+void AnytimeSearch::clear() {
+    active = false;
+    finished = false;
+    path.clear();
+    bound = 0.0;
+}
+
+void AnytimeSearch::restart() {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    version = grid.getVersion();
+    size_t cells = static_cast<size_t>(width) * height;
+    if (g.size() != cells) {
+        g.assign(cells, 0);
+        parents.assign(cells, -1);
+        stamps.assign(cells, 0);
+        closed.assign(cells, 0);
+        inconsistent.assign(cells, 0);
+        generation = 0;
+        pass = 0;
+    }
+    if (++generation == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+    advancePass();
+    incons.clear();
+    open.reset(static_cast<int>(cells));
+    path.clear();
+    bound = 0.0;
+    weight = initialWeight;
+    finished = false;
+
+    if (!grid.isPassable(start.x, start.y) || !grid.isPassable(goal.x, goal.y) ||
+        !grid.isReachable(start.x, start.y, goal.x, goal.y)) {
+        finished = true;
+        return;
+    }
+    startIndex = start.y * width + start.x;
+    goalIndex = goal.y * width + goal.x;
+    setG(startIndex, 0, -1);
+    open.push(startIndex, weight * heuristic(startIndex), 0);
+}
+
+void AnytimeSearch::advancePass() {
+    passExpanded = 0;
+    if (++pass == 0) {
+        std::fill(closed.begin(), closed.end(), 0);
+        std::fill(inconsistent.begin(), inconsistent.end(), 0);
+        pass = 1;
+    }
+}
+
+int AnytimeSearch::heuristic(int index) const {
+    return std::abs(index % width - goal.x) + std::abs(index / width - goal.y);
+}
+
+bool AnytimeSearch::improve(std::chrono::microseconds timeBudget, size_t expansionBudget) {
+    expanded = 0;
+    if (!active || finished) {
+        return false;
+    }
+    if (grid.getVersion() != version) {
+        restart(); // the path and g values may no longer hold
+        if (finished) {
+            return false;
+        }
+    }
+    bool timed = timeBudget.count() > 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeBudget;
+    bool improved = false;
+
+    while (true) {
+        // One pass: expand while some queued cell could still lead to a path below the weighted bound
+        while (!open.empty() && (getG(goalIndex) >= INF || getG(goalIndex) * WEIGHT_SCALE > open.top().f)) {
+            if ((expansionBudget > 0 && expanded >= expansionBudget) ||
+                (timed && (expanded & (DEADLINE_CHECK_INTERVAL - 1)) == 0 && std::chrono::steady_clock::now() >= deadline)) {
+                return improved; // resumed from here by the next call
+            }
+            OpenEntry current = open.pop();
+            closed[current.index] = pass;
+            ++expanded;
+            ++passExpanded;
+            ++totalExpanded;
+
+            int neighbors[8];
+            int costs[8];
+            int count = WeightedFourConnected::expand(grid, current.index, neighbors, costs);
+            for (int i = 0; i < count; ++i) {
+                int neighbor = neighbors[i];
+                int tentative_g = getG(current.index) + costs[i];
+                if (tentative_g >= getG(neighbor)) {
+                    continue;
+                }
+                setG(neighbor, tentative_g, current.index);
+                if (closed[neighbor] == pass) {
+                    // Already expanded in this pass; the next pass takes it up again
+                    if (inconsistent[neighbor] != pass) {
+                        inconsistent[neighbor] = pass;
+                        incons.push_back(neighbor);
+                    }
+                    continue;
+                }
+                int f = tentative_g * WEIGHT_SCALE + weight * heuristic(neighbor);
+                if (open.contains(neighbor)) {
+                    open.decreaseKey(neighbor, f, tentative_g);
+                }
+                else {
+                    open.push(neighbor, f, tentative_g);
+                }
+            }
+        }
+
+        if (getG(goalIndex) >= INF) {
+            finished = true; // the open list ran dry: no path
+            return improved;
+        }
+        if (path.empty() || passExpanded > 0) {
+            // g along the parents can be stale where a cell improved after its children were
+            // reached, so the path's own g values are summed from the start instead
+            path.clear();
+            for (int index = goalIndex; index != -1; index = parents[index]) {
+                path.push_back(Node(index % width, index / width));
+            }
+            std::reverse(path.begin(), path.end());
+            for (size_t i = 1; i < path.size(); ++i) {
+                path[i].g = path[i - 1].g + grid.getStepCost(path[i].y * width + path[i].x);
+            }
+        }
+        improved = true;
+        if (weight == WEIGHT_SCALE) {
+            bound = 1.0;
+            finished = true;
+            return improved;
+        }
+        nextPass();
+        if (bound <= 1.0) {
+            finished = true; // nothing queued could lead anywhere cheaper
+            return improved;
+        }
+    }
+}
+
+void AnytimeSearch::nextPass() {
+    pending.assign(open.getEntries().begin(), open.getEntries().end());
+    for (int index : incons) {
+        pending.push_back({ 0, g[index], index });
+    }
+    incons.clear();
+
+    // No path can cost less than the lowest unweighted f still queued
+    int lowest = INF;
+    for (const OpenEntry& entry : pending) {
+        lowest = std::min(lowest, g[entry.index] + heuristic(entry.index));
+    }
+    int cost = g[goalIndex];
+    double weighted = static_cast<double>(weight) / WEIGHT_SCALE;
+    bound = lowest >= cost ? 1.0 : std::min(weighted, static_cast<double>(cost) / lowest);
+
+    weight = weight - weightStep > WEIGHT_SCALE ? weight - weightStep : WEIGHT_SCALE;
+    advancePass();
+    open.reset(width * height);
+    for (const OpenEntry& entry : pending) {
+        int index = entry.index;
+        open.push(index, g[index] * WEIGHT_SCALE + weight * heuristic(index), g[index]);
+    }
+}
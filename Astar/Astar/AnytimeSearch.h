@@ -0,0 +1,96 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "Pathfinding.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Anytime planner (ARA*) for one start/goal pair, for callers with a fixed time or
+// expansion budget per tick. The first pass is weighted A* with f = g + weight * h, which
+// finds a path costing at most weight times the optimum after far fewer expansions than
+// A*. Each later pass lowers the weight and reuses the work before it: only the cells
+// whose g improved since they were expanded are searched again. The last pass has weight
+// 1 and leaves the optimal path. improve() stops when its budget runs out and picks up
+// where it left off on the next call.
+// 4-connected, with the grid's terrain costs and the Manhattan heuristic, like
+// Pathfinding::findPath in AStar mode. Edits to the grid restart the search.
+class AnytimeSearch {
+public:
+    // Weights are fixed point in units of 1 / WEIGHT_SCALE
+    static const int WEIGHT_SCALE = 64;
+
+    explicit AnytimeSearch(const Grid& grid);
+
+    // Start a new query. The first pass uses initialWeight (at least 1) and each pass after
+    // lowers it by weightStep, down to 1.
+    void plan(const Node& start, const Node& goal, double initialWeight = 3.0, double weightStep = 0.5);
+    // Forget the current query
+    void clear();
+    bool isActive() const { return active; }
+
+    // Search until the path is known to be optimal or the budget is spent; a zero budget
+    // means no limit of that kind. The deadline is checked every few dozen expansions.
+    // Returns whether a better bounded path was found during the call.
+    bool improve(std::chrono::microseconds timeBudget, size_t expansionBudget = 0);
+    // Optimal path found, or none exists; improve() has nothing left to do
+    bool isFinished() const { return finished; }
+
+    // Best path so far, as Pathfinding::findPath returns it; empty until the first pass ends
+    const std::vector<Node>& getPath() const { return path; }
+    // The path costs at most this many times the optimum; 1 once it is optimal, 0 while there is none
+    double getBound() const { return bound; }
+    // Weight of the pass in progress
+    double getWeight() const { return static_cast<double>(weight) / WEIGHT_SCALE; }
+    // Cells expanded by the last improve(), and by all passes of this query
+    size_t getExpanded() const { return expanded; }
+    size_t getTotalExpanded() const { return totalExpanded; }
+private:
+    static const size_t DEADLINE_CHECK_INTERVAL = 64; // power of two
+    static const int INF = 1 << 30;
+
+    int heuristic(int index) const;
+    // g of a cell in this query; INF until it is reached
+    int getG(int index) const { return stamps[index] == generation ? g[index] : static_cast<int>(INF); }
+    void setG(int index, int cost, int parent) {
+        stamps[index] = generation;
+        g[index] = cost;
+        parents[index] = parent;
+    }
+    // Move to a new pass number; numbers are never reused, so nothing is cleared per pass
+    void advancePass();
+    // Lower the weight and queue the open and inconsistent cells under their new keys; also
+    // works out the bound of the path just found from the same cells
+    void nextPass();
+    // Set up the first pass from scratch, for the grid as it is now
+    void restart();
+
+    const Grid& grid;
+    int width;
+    int height;
+    bool active;
+    bool finished;
+    Node start;
+    Node goal;
+    int startIndex;
+    int goalIndex;
+    int initialWeight; // fixed point
+    int weightStep;    // fixed point
+    int weight;        // fixed point
+    std::uint32_t pass;
+    std::uint32_t generation; // per query, as in SearchState
+    std::uint64_t version;    // of the grid when the search started
+    std::vector<int> g;
+    std::vector<int> parents;
+    std::vector<std::uint32_t> stamps;
+    std::vector<std::uint32_t> closed;       // pass in which each cell was last expanded
+    std::vector<std::uint32_t> inconsistent; // pass in which each cell joined incons
+    std::vector<int> incons; // expanded this pass, then improved; reopened by the next pass
+    std::vector<OpenEntry> pending;
+    IndexedHeap<4> open;
+    std::vector<Node> path;
+    double bound;
+    size_t expanded;
+    size_t passExpanded; // a pass that expands nothing leaves the path as it was
+    size_t totalExpanded;
+};
@@ -0,0 +1,12 @@
+#include "BatchPathfinder.h"
+
+BatchPathfinder::BatchPathfinder(unsigned threads) : pool(threads), scratch(pool.size()) {}
+
+std::vector<std::vector<Node>> BatchPathfinder::findPaths(const Grid& grid, const std::vector<PathRequest>& requests,
+                                                          SearchMode mode, const JumpTable* jumpTable) {
+    std::vector<std::vector<Node>> paths(requests.size());
+    pool.parallelFor(requests.size(), [&](size_t i, unsigned worker) {
+        paths[i] = Pathfinding::findPath(grid, requests[i].start, requests[i].end, scratch[worker], mode, jumpTable);
+    });
+    return paths;
+}
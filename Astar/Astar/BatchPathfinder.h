@@ -0,0 +1,28 @@
+#pragma once
+#include "Grid.h"
+#include "JumpTable.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include "ThreadPool.h"
+#include <vector>
+
+struct PathRequest {
+    Node start;
+    Node end;
+};
+
+// Solves many independent queries against one read-only Grid in parallel.
+// Each pool worker owns a SearchState that it reuses for every query it runs,
+// so workers share nothing but the (unmodified) grid and jump table.
+class BatchPathfinder {
+public:
+    explicit BatchPathfinder(unsigned threads = std::thread::hardware_concurrency());
+
+    // paths[i] answers requests[i]. The grid and table must not change until this returns.
+    std::vector<std::vector<Node>> findPaths(const Grid& grid, const std::vector<PathRequest>& requests,
+                                             SearchMode mode = SearchMode::AStar, const JumpTable* jumpTable = nullptr);
+    unsigned getThreadCount() const { return pool.size(); }
+private:
+    ThreadPool pool;
+    std::vector<SearchState> scratch; // one per worker
+};
@@ -0,0 +1,114 @@
+#include "BidirectionalSearch.h"
+#include <algorithm>
+#include <climits>
+
+BidirectionalSearch::BidirectionalSearch()
+    : cells(0), generation(0), best(NO_MEETING), done(false), pending(false), stopping(false) {
+    helper = std::thread(&BidirectionalSearch::helperLoop, this);
+}
+
+BidirectionalSearch::~BidirectionalSearch() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    helper.join();
+}
+
+void BidirectionalSearch::begin(int width, int height) {
+    size_t size = static_cast<size_t>(width) * height;
+    if (size != cells) {
+        cells = size;
+        forward.published.reset(new std::atomic<std::uint64_t>[cells]);
+        backward.published.reset(new std::atomic<std::uint64_t>[cells]);
+        generation = 0;
+    }
+    // Generation 0 marks cells no query has touched: start fresh arrays at 1 and skip 0 when the counter wraps
+    ++generation;
+    if (generation == 0 || generation == 1) {
+        for (size_t i = 0; i < cells; ++i) {
+            forward.published[i].store(0, std::memory_order_relaxed);
+            backward.published[i].store(0, std::memory_order_relaxed);
+        }
+        generation = 1;
+    }
+    forward.state.begin(width, height);
+    backward.state.begin(width, height);
+    best.store(NO_MEETING);
+    done.store(false);
+}
+
+void BidirectionalSearch::publish(Frontier& own, int index, int g) {
+    own.published[index].store(static_cast<std::uint64_t>(generation) << 32 | static_cast<std::uint32_t>(g));
+}
+
+void BidirectionalSearch::meet(const Frontier& other, int index, int g) {
+    // Sequentially consistent with the publish() just before it, so of two threads
+    // reaching the same cell at least one sees the other's value
+    std::uint64_t value = other.published[index].load();
+    if (value >> 32 != generation) {
+        return;
+    }
+    std::uint64_t cost = static_cast<std::uint64_t>(g) + static_cast<std::uint32_t>(value);
+    std::uint64_t candidate = cost << 32 | static_cast<std::uint32_t>(index);
+    std::uint64_t current = best.load();
+    while (candidate < current && !best.compare_exchange_weak(current, candidate)) {
+    }
+}
+
+int BidirectionalSearch::bestCost() const {
+    std::uint64_t value = best.load(std::memory_order_relaxed);
+    return value == NO_MEETING ? INT_MAX : static_cast<int>(value >> 32);
+}
+
+std::vector<Node> BidirectionalSearch::buildPath(int meeting) const {
+    // Both threads have finished, so the parents are stable; later improvements a frontier
+    // made after recording the meeting only make its half shorter
+    int width = forward.state.getWidth();
+    std::vector<Node> path;
+    for (int index = meeting; index != -1; index = forward.state.getParent(index)) {
+        Node node(index % width, index / width);
+        node.g = forward.state.getG(index);
+        path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+    int total = path.back().g + backward.state.getG(meeting);
+    for (int index = backward.state.getParent(meeting); index != -1; index = backward.state.getParent(index)) {
+        Node node(index % width, index / width);
+        node.g = total - backward.state.getG(index);
+        path.push_back(node);
+    }
+    return path;
+}
+
+void BidirectionalSearch::startHelper(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = work;
+        pending = true;
+    }
+    wake.notify_all();
+}
+
+void BidirectionalSearch::waitHelper() {
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this] { return !pending; });
+}
+
+void BidirectionalSearch::helperLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || (pending && task); });
+        if (stopping) {
+            return;
+        }
+        std::function<void()> work = task;
+        lock.unlock();
+        work();
+        lock.lock();
+        task = nullptr;
+        pending = false;
+        wake.notify_all();
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinding.h"
+#include "SearchPolicies.h"
+#include "SearchState.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bidirectional A*: a forward search from start on the calling thread and a backward
+// search from end on a helper thread, with the same neighbor and heuristic policies
+// (the neighbor policies are all symmetric, so searching backwards is the same search).
+// Both frontiers use the average of the two heuristics, (h_end - h_start) / 2 forwards
+// and its negation backwards, doubled to stay in integers. That makes both of them
+// Dijkstra searches on one reduced-cost graph, so the query can stop as soon as the
+// smallest keys of the two open lists add up to at least twice the cheapest meeting
+// so far (mu), wherever the frontiers meet, rather than when one frontier alone
+// proves mu optimal.
+// Each frontier publishes the g of every cell it reaches, and its current smallest key,
+// in atomics; after publishing its own value a thread reads the other's, so whenever
+// both reach a cell at least one of them sees the meeting. mu is one packed atomic.
+// Both frontiers poll the stop condition of the caller's SearchState, if one is given,
+// and whichever notices it first ends the query with no path.
+// The heuristic must be consistent, as all the default policy pairs are.
+// Gains little in practice: on mazes it expands about as much as A*, and on an open
+// random map it was about 3x slower (1502 vs 468 us per query) with more expansions,
+// as two half-informed frontiers cover more ground than one A* frontier.
+class BidirectionalSearch {
+public:
+    BidirectionalSearch();
+    ~BidirectionalSearch();
+    BidirectionalSearch(const BidirectionalSearch&) = delete;
+    BidirectionalSearch& operator=(const BidirectionalSearch&) = delete;
+
+    // The frontiers have states of their own; state, if given, is begun and finished for the
+    // query, lends its stop condition and reports wasStopped() and both frontiers' expansions
+    template <typename Neighbors, typename Heuristic>
+    std::vector<Node> findPath(const Grid& grid, const Node& start, const Node& end, SearchState* state = nullptr);
+    // Cells expanded by both frontiers in the last query
+    size_t getExpanded() const { return forward.state.getExpanded() + backward.state.getExpanded(); }
+private:
+    static const std::uint64_t NO_MEETING = ~0ULL;
+
+    struct Frontier {
+        SearchState state;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> published; // generation << 32 | g
+        std::atomic<int> minKey; // no larger than any key still on the open list
+    };
+
+    // Prepare both frontiers for a query on a width x height grid
+    void begin(int width, int height);
+    void publish(Frontier& own, int index, int g);
+    // Record a meeting if the other frontier has reached index too
+    void meet(const Frontier& other, int index, int g);
+    int bestCost() const;
+    // Expand own until the two frontiers prove mu optimal; source is the end own started from
+    template <typename Neighbors, typename Heuristic>
+    void search(const Grid& grid, Frontier& own, const Frontier& other, const Node& source, const Node& target);
+    std::vector<Node> buildPath(int meeting) const;
+    // Run task on the helper thread while the caller does its own part; wait() joins it
+    void startHelper(std::function<void()> task);
+    void waitHelper();
+    void helperLoop();
+
+    Frontier forward;
+    Frontier backward;
+    size_t cells;
+    std::uint32_t generation;
+    std::atomic<std::uint64_t> best; // mu << 32 | meeting cell, NO_MEETING when there is none
+    std::atomic<bool> done;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::function<void()> task;
+    bool pending;
+    bool stopping;
+    std::thread helper;
+};
+
+template <typename Neighbors, typename Heuristic>
+std::vector<Node> BidirectionalSearch::findPath(const Grid& grid, const Node& start, const Node& end, SearchState* state) {
+    int width = grid.getWidth();
+    begin(width, grid.getHeight());
+    if (state) {
+        state->begin(width, grid.getHeight());
+        state->shareStopCondition(forward.state);
+        state->shareStopCondition(backward.state);
+    }
+    else {
+        forward.state.clearStopCondition();
+        backward.state.clearStopCondition();
+    }
+    if (!grid.isPassable(start.x, start.y) || !grid.isPassable(end.x, end.y) ||
+        (!Neighbors::CUTS_CORNERS && !grid.isReachable(start.x, start.y, end.x, end.y))) {
+        if (state) {
+            state->finish();
+        }
+        return std::vector<Node>();
+    }
+
+    int startIndex = start.y * width + start.x;
+    int endIndex = end.y * width + end.x;
+    int h = Heuristic::template estimate<Neighbors>(std::abs(start.x - end.x), std::abs(start.y - end.y));
+    forward.state.open(startIndex, 0, -1);
+    forward.state.getOpenList().push(startIndex, h, 0);
+    forward.minKey = h;
+    publish(forward, startIndex, 0);
+    backward.state.open(endIndex, 0, -1);
+    backward.state.getOpenList().push(endIndex, h, 0);
+    backward.minKey = h;
+    publish(backward, endIndex, 0);
+    meet(backward, startIndex, 0); // start == end
+
+    startHelper([&] { search<Neighbors, Heuristic>(grid, backward, forward, end, start); });
+    search<Neighbors, Heuristic>(grid, forward, backward, start, end);
+    waitHelper();
+
+    bool stopped = forward.state.wasStopped() || backward.state.wasStopped();
+    if (state) {
+        state->setStopped(stopped);
+        state->addExpanded(getExpanded());
+        state->finish();
+    }
+    std::uint64_t meeting = best.load();
+    if (meeting == NO_MEETING || stopped) {
+        return std::vector<Node>();
+    }
+    return buildPath(static_cast<int>(meeting & 0xFFFFFFFFu));
+}
+
+template <typename Neighbors, typename Heuristic>
+void BidirectionalSearch::search(const Grid& grid, Frontier& own, const Frontier& other, const Node& source, const Node& target) {
+    int width = grid.getWidth();
+    SearchState& state = own.state;
+    SearchState::OpenList& openList = state.getOpenList();
+
+    while (!done.load(std::memory_order_relaxed) && !openList.empty()) {
+        // Keys only grow, so a stale minKey from the other thread is still a lower bound
+        int key = openList.top().f;
+        own.minKey.store(key);
+        if (static_cast<std::int64_t>(key) + other.minKey.load() >= 2 * static_cast<std::int64_t>(bestCost())) {
+            break;
+        }
+        OpenEntry current = openList.pop();
+        state.close(current.index);
+        if (state.shouldStop()) {
+            break; // ends the other frontier too
+        }
+
+        int neighbors[8];
+        int costs[8];
+        int count = Neighbors::expand(grid, current.index, neighbors, costs);
+        for (int i = 0; i < count; ++i) {
+            int neighbor = neighbors[i];
+            if (state.isClosed(neighbor)) {
+                continue;
+            }
+            int tentative_g = current.g + costs[i];
+            bool queued = state.isOpen(neighbor);
+            if (queued && tentative_g >= state.getG(neighbor)) {
+                continue;
+            }
+
+            int x = neighbor % width;
+            int y = neighbor / width;
+            int potential = Heuristic::template estimate<Neighbors>(std::abs(x - target.x), std::abs(y - target.y))
+                - Heuristic::template estimate<Neighbors>(std::abs(x - source.x), std::abs(y - source.y));
+            int k = 2 * tentative_g + potential;
+            state.open(neighbor, tentative_g, current.index);
+            publish(own, neighbor, tentative_g);
+            meet(other, neighbor, tentative_g);
+            if (queued) {
+                openList.decreaseKey(neighbor, k, tentative_g);
+            }
+            else {
+                openList.push(neighbor, k, tentative_g);
+            }
+        }
+    }
+    // Whichever frontier stops first ends the query: mu is optimal, or nothing is reachable
+    done.store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "IndexedHeap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Open list for integer keys that mostly stay within BUCKETS - 1 of the lowest queued key
+// (Dial's algorithm). That holds for A* with a consistent heuristic as long as one step
+// raises f by less than BUCKETS. Keys index a ring of buckets, so push and pop are O(1)
+// apart from skipping empty buckets, which costs at most the spread of the keys per pop.
+// Keys further ahead wait in an overflow list until the ring reaches them, so the order
+// is always right; it just gets slower when that happens often.
+// decreaseKey() pushes a second entry instead of moving the first; pop() skips entries
+// that have been superseded. Within one f the entry pushed last comes out first, which
+// like IndexedHeap's tie break favours the deeper cells.
+template <int BUCKETS = 512>
+class BucketQueue {
+public:
+    static_assert((BUCKETS & (BUCKETS - 1)) == 0, "BUCKETS must be a power of two");
+
+    BucketQueue() : buckets(BUCKETS), overflowMin(0), current(0), count(0), stale(0), generation(0) {}
+
+    // Empty the queue and make room for cell indices in [0, cells)
+    void reset(int cells) {
+        if (count > 0 || stale > 0) {
+            for (std::vector<OpenEntry>& bucket : buckets) {
+                bucket.clear();
+            }
+            overflow.clear();
+        }
+        count = 0;
+        stale = 0;
+        if (latest.size() < static_cast<size_t>(cells)) {
+            latest.resize(cells, 0);
+            stamps.resize(cells, 0);
+        }
+        if (++generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    bool contains(int index) const { return stamps[index] == generation && latest[index] >= 0; }
+
+    void push(int index, int f, int g) {
+        if (count == 0 || f < current) {
+            current = f;
+        }
+        place({ f, g, index });
+        stamps[index] = generation;
+        latest[index] = g;
+        ++count;
+    }
+
+    // Lower the key of a queued cell
+    void decreaseKey(int index, int f, int g) {
+        if (f < current) {
+            current = f;
+        }
+        place({ f, g, index });
+        latest[index] = g;
+        ++stale;
+    }
+
+    // Not const: superseded entries in front of the live one are dropped on the way
+    const OpenEntry& top() {
+        while (true) {
+            std::vector<OpenEntry>& bucket = buckets[current & (BUCKETS - 1)];
+            if (bucket.empty()) {
+                ++current;
+                if (!overflow.empty() && overflowMin < current + BUCKETS) {
+                    refill();
+                }
+            }
+            else if (latest[bucket.back().index] != bucket.back().g) {
+                bucket.pop_back(); // superseded by a decreaseKey
+                --stale;
+            }
+            else if (bucket.back().f != current) {
+                // Queued a full ring ahead, before a lower key moved current back
+                OpenEntry ahead = bucket.back();
+                bucket.pop_back();
+                toOverflow(ahead);
+            }
+            else {
+                return bucket.back();
+            }
+        }
+    }
+
+    OpenEntry pop() {
+        OpenEntry entry = top();
+        buckets[current & (BUCKETS - 1)].pop_back();
+        latest[entry.index] = -1;
+        --count;
+        return entry;
+    }
+private:
+    void place(const OpenEntry& entry) {
+        if (entry.f - current < BUCKETS) {
+            buckets[entry.f & (BUCKETS - 1)].push_back(entry);
+        }
+        else {
+            toOverflow(entry);
+        }
+    }
+
+    void toOverflow(const OpenEntry& entry) {
+        if (overflow.empty() || entry.f < overflowMin) {
+            overflowMin = entry.f;
+        }
+        overflow.push_back(entry);
+    }
+
+    // Move the overflow entries the ring has caught up with into their buckets
+    void refill() {
+        std::vector<OpenEntry> waiting;
+        waiting.swap(overflow);
+        for (const OpenEntry& entry : waiting) {
+            place(entry);
+        }
+    }
+
+    std::vector<std::vector<OpenEntry>> buckets;
+    std::vector<OpenEntry> overflow; // keys at least BUCKETS past current
+    int overflowMin;
+    int current; // lowest key that may still be queued
+    size_t count; // queued cells, not counting superseded entries
+    size_t stale; // superseded entries still in the buckets
+    std::vector<int> latest; // g of the live entry of each queued cell, -1 once popped
+    std::vector<std::uint32_t> stamps;
+    std::uint32_t generation;
+};
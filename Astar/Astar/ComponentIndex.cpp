@@ -0,0 +1,385 @@
+#include "ComponentIndex.h"
+#include "Bits.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    // A horizontal run of free cells [x0, x1) and its union-find parent during build()
+    struct BuildRun {
+        int x0, x1;
+        int parent;
+    };
+
+    int findRoot(std::vector<BuildRun>& runs, int run) {
+        while (runs[run].parent != run) {
+            runs[run].parent = runs[runs[run].parent].parent;
+            run = runs[run].parent;
+        }
+        return run;
+    }
+}
+
+ComponentIndex::ComponentIndex() : width(0), height(0), built(false), sizes(1, 0) {}
+
+ComponentIndex::ComponentIndex(const ComponentIndex& other)
+    : width(other.width), height(other.height), built(other.built), rows(other.rows), sizes(other.sizes),
+      freeLabels(other.freeLabels) {}
+
+ComponentIndex& ComponentIndex::operator=(const ComponentIndex& other) {
+    width = other.width;
+    height = other.height;
+    built = other.built;
+    rows = other.rows;
+    sizes = other.sizes;
+    freeLabels = other.freeLabels;
+    return *this;
+}
+
+void ComponentIndex::build(const Grid& grid) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+
+    // Collect the runs of free cells of each row, a word at a time, and join every run
+    // to the runs it touches in the row above
+    std::vector<BuildRun> runs;
+    std::vector<size_t> rowStart(static_cast<size_t>(height) + 1, 0);
+    for (int y = 0; y < height; ++y) {
+        rowStart[y] = runs.size();
+        for (int x = 0; x < width; x += 64) {
+            std::uint64_t free = ~grid.rowBits(x, y); // padding past the edge reads as obstacles
+            while (free != 0) {
+                int begin = countTrailingZeros(free);
+                std::uint64_t rest = ~(free >> begin);
+                int end = rest == 0 ? 64 : begin + countTrailingZeros(rest);
+                free = end == 64 ? 0 : free & (~0ULL << end);
+                if (begin == 0 && runs.size() > rowStart[y] && runs.back().x1 == x) {
+                    runs.back().x1 = x + end; // continues from the previous word
+                }
+                else {
+                    int run = static_cast<int>(runs.size());
+                    runs.push_back({ x + begin, x + end, run });
+                }
+            }
+        }
+
+        if (y > 0) {
+            size_t above = rowStart[y - 1];
+            size_t current = rowStart[y];
+            while (above < rowStart[y] && current < runs.size()) {
+                if (runs[above].x0 < runs[current].x1 && runs[current].x0 < runs[above].x1) {
+                    int a = findRoot(runs, static_cast<int>(above));
+                    int b = findRoot(runs, static_cast<int>(current));
+                    if (a != b) {
+                        runs[std::max(a, b)].parent = std::min(a, b);
+                    }
+                }
+                if (runs[above].x1 <= runs[current].x1) {
+                    ++above;
+                }
+                else {
+                    ++current;
+                }
+            }
+        }
+    }
+    rowStart[height] = runs.size();
+
+    // Number the roots in order and label the runs
+    rows.assign(height, std::vector<Run>());
+    sizes.assign(1, 0);
+    freeLabels.clear();
+    std::vector<int> rootLabel(runs.size(), 0);
+    for (int y = 0; y < height; ++y) {
+        std::vector<Run>& row = rows[y];
+        row.reserve(rowStart[y + 1] - rowStart[y]);
+        for (size_t run = rowStart[y]; run < rowStart[y + 1]; ++run) {
+            int root = findRoot(runs, static_cast<int>(run));
+            if (rootLabel[root] == 0) {
+                rootLabel[root] = static_cast<int>(sizes.size());
+                sizes.push_back(0);
+            }
+            int label = rootLabel[root];
+            row.push_back({ runs[run].x0, runs[run].x1, label });
+            sizes[label] += runs[run].x1 - runs[run].x0;
+        }
+    }
+    built = true;
+}
+
+void ComponentIndex::clear() {
+    built = false;
+    rows.clear();
+    sizes.assign(1, 0);
+    freeLabels.clear();
+    marks.clear();
+}
+
+int ComponentIndex::get(int index) const {
+    int y = index / width;
+    int run = findRun(index % width, y);
+    return run < 0 ? 0 : rows[y][run].label;
+}
+
+int ComponentIndex::findRun(int x, int y) const {
+    const std::vector<Run>& row = rows[y];
+    int run = firstOverlap(y, x);
+    return run < static_cast<int>(row.size()) && row[run].x0 <= x ? run : -1;
+}
+
+int ComponentIndex::firstOverlap(int y, int x0) const {
+    const std::vector<Run>& row = rows[y];
+    return static_cast<int>(std::partition_point(row.begin(), row.end(), [x0](const Run& run) { return run.x1 <= x0; }) - row.begin());
+}
+
+int ComponentIndex::newLabel() {
+    if (!freeLabels.empty()) {
+        int label = freeLabels.back();
+        freeLabels.pop_back();
+        return label;
+    }
+    sizes.push_back(0);
+    return static_cast<int>(sizes.size()) - 1;
+}
+
+void ComponentIndex::releaseLabel(int label) {
+    sizes[label] = 0;
+    freeLabels.push_back(label);
+}
+
+void ComponentIndex::relabel(RunRef at, int from, int to) {
+    std::vector<RunRef>& queue = queues[0];
+    queue.clear();
+    rows[at.y][at.run].label = to;
+    queue.push_back(at);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Run current = rows[queue[head].y][queue[head].run];
+        int y = queue[head].y;
+        // Runs in the rows above and below touch this one where their columns overlap
+        for (int ny = y - 1; ny <= y + 1; ny += 2) {
+            if (ny < 0 || ny >= height) {
+                continue;
+            }
+            std::vector<Run>& row = rows[ny];
+            for (int run = firstOverlap(ny, current.x0); run < static_cast<int>(row.size()) && row[run].x0 < current.x1; ++run) {
+                if (row[run].label == from) {
+                    row[run].label = to;
+                    queue.push_back({ ny, run });
+                }
+            }
+        }
+    }
+}
+
+void ComponentIndex::onFreed(int x, int y) {
+    std::vector<Run>& row = rows[y];
+    int left = x > 0 ? findRun(x - 1, y) : -1;
+    int right = x + 1 < width ? findRun(x + 1, y) : -1;
+
+    // The runs around the cell; the ones above and below are looked up again after each
+    // relabel, which keeps positions but may change labels
+    auto neighbor = [&](int i, RunRef& at) {
+        if (i == 0 || i == 1) {
+            at.y = y;
+            at.run = i == 0 ? left : right;
+        }
+        else {
+            at.y = i == 2 ? y - 1 : y + 1;
+            at.run = at.y >= 0 && at.y < height ? findRun(x, at.y) : -1;
+        }
+        return at.run < 0 ? 0 : rows[at.y][at.run].label;
+    };
+
+    // Join the cell to the largest region around it and move the others over. This is
+    // done before the row changes, while the run positions still hold.
+    RunRef at = { 0, 0 };
+    int largest = 0;
+    for (int i = 0; i < 4; ++i) {
+        int label = neighbor(i, at);
+        if (label != 0 && (largest == 0 || sizes[label] > sizes[largest])) {
+            largest = label;
+        }
+    }
+    if (largest == 0) {
+        largest = newLabel();
+    }
+    for (int i = 0; i < 4; ++i) {
+        int label = neighbor(i, at);
+        if (label != 0 && label != largest) {
+            sizes[largest] += sizes[label];
+            relabel(at, label, largest);
+            releaseLabel(label);
+        }
+    }
+    ++sizes[largest];
+
+    // Grow, join or add the run of the cell
+    if (left >= 0 && right >= 0) {
+        row[left].x1 = row[right].x1;
+        row.erase(row.begin() + right);
+    }
+    else if (left >= 0) {
+        row[left].x1 = x + 1;
+    }
+    else if (right >= 0) {
+        row[right].x0 = x;
+    }
+    else {
+        Run run = { x, x + 1, largest };
+        row.insert(row.begin() + firstOverlap(y, x), run);
+    }
+}
+
+void ComponentIndex::onBlocked(int x, int y) {
+    std::vector<Run>& row = rows[y];
+    int run = findRun(x, y);
+    Run old = row[run];
+    int label = old.label;
+    --sizes[label];
+
+    // Cut the cell out of its run
+    if (old.x1 - old.x0 == 1) {
+        row.erase(row.begin() + run);
+    }
+    else if (old.x0 == x) {
+        row[run].x0 = x + 1;
+    }
+    else if (old.x1 == x + 1) {
+        row[run].x1 = x;
+    }
+    else {
+        row[run].x1 = x;
+        Run rest = { x + 1, old.x1, label };
+        row.insert(row.begin() + run + 1, rest);
+    }
+
+    // Walk the eight surrounding cells in order; consecutive ones share an edge, so the
+    // free 4-neighbors within one unbroken arc of free cells are still connected
+    const int ringX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    const int ringY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+    bool free[8];
+    int firstGap = -1;
+    for (int i = 0; i < 8; ++i) {
+        int nx = x + ringX[i];
+        int ny = y + ringY[i];
+        free[i] = nx >= 0 && nx < width && ny >= 0 && ny < height && findRun(nx, ny) >= 0;
+        if (!free[i] && firstGap < 0) {
+            firstGap = i;
+        }
+    }
+    RunRef seeds[4];
+    int sides = 0;
+    int straight = 0;
+    if (firstGap < 0) {
+        return; // surrounded by free cells
+    }
+    bool arcHasSeed = false;
+    for (int step = 1; step <= 8; ++step) {
+        int i = (firstGap + step) & 7;
+        if (!free[i]) {
+            arcHasSeed = false;
+        }
+        else if ((i & 1) == 0) { // N, E, S and W are the even positions
+            ++straight;
+            if (!arcHasSeed) {
+                seeds[sides].y = y + ringY[i];
+                seeds[sides].run = findRun(x + ringX[i], y + ringY[i]);
+                ++sides;
+                arcHasSeed = true;
+            }
+        }
+    }
+    if (straight == 0) {
+        releaseLabel(label);
+        return;
+    }
+    if (sides < 2) {
+        return;
+    }
+
+    // The region may have split. Search from every side at once, one run per side per
+    // round; sides that meet join up, and a group of sides that runs out of runs is a
+    // region of its own. The last group left keeps the old label.
+    auto key = [this](RunRef at) {
+        return static_cast<std::int64_t>(at.y) * width + rows[at.y][at.run].x0;
+    };
+    marks.clear();
+    int group[4];
+    size_t heads[4];
+    bool closed[4] = { false, false, false, false };
+    for (int s = 0; s < sides; ++s) {
+        group[s] = s;
+        heads[s] = 0;
+        queues[s].clear();
+        queues[s].push_back(seeds[s]);
+        marks[key(seeds[s])] = s;
+    }
+    auto root = [&group](int s) {
+        while (group[s] != s) {
+            s = group[s];
+        }
+        return s;
+    };
+    int open = sides;
+    while (open > 1) {
+        for (int s = 0; s < sides; ++s) {
+            if (closed[root(s)] || heads[s] == queues[s].size()) {
+                continue;
+            }
+            RunRef at = queues[s][heads[s]++];
+            Run current = rows[at.y][at.run];
+            for (int ny = at.y - 1; ny <= at.y + 1; ny += 2) {
+                if (ny < 0 || ny >= height) {
+                    continue;
+                }
+                const std::vector<Run>& next = rows[ny];
+                for (int r = firstOverlap(ny, current.x0); r < static_cast<int>(next.size()) && next[r].x0 < current.x1; ++r) {
+                    if (next[r].label != label) {
+                        continue;
+                    }
+                    RunRef reached = { ny, r };
+                    std::unordered_map<std::int64_t, int>::iterator mark = marks.find(key(reached));
+                    if (mark != marks.end()) {
+                        int a = root(s);
+                        int b = root(mark->second);
+                        if (a != b) {
+                            group[std::max(a, b)] = std::min(a, b);
+                            --open;
+                        }
+                    }
+                    else {
+                        marks.emplace(key(reached), s);
+                        queues[s].push_back(reached);
+                    }
+                }
+            }
+        }
+
+        for (int g = 0; g < sides && open > 1; ++g) {
+            if (root(g) != g || closed[g]) {
+                continue;
+            }
+            bool exhausted = true;
+            for (int s = 0; s < sides; ++s) {
+                if (root(s) == g && heads[s] != queues[s].size()) {
+                    exhausted = false;
+                }
+            }
+            if (exhausted) {
+                int split = newLabel();
+                for (int s = 0; s < sides; ++s) {
+                    if (root(s) == g) {
+                        for (RunRef piece : queues[s]) {
+                            Run& moved = rows[piece.y][piece.run];
+                            moved.label = split;
+                            sizes[split] += moved.x1 - moved.x0;
+                        }
+                    }
+                }
+                sizes[label] -= sizes[split];
+                closed[g] = true;
+                --open;
+            }
+        }
+    }
+}
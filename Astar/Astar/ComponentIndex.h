@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Grid;
+
+// Labels the 4-connected regions of free cells of a Grid, so that "can end be reached
+// from start" is a label comparison. build() labels the whole grid from runs of free
+// cells found a word (64 cells) at a time. After that the owning Grid reports every
+// edit: freeing a cell merges the regions around it by relabelling the smaller ones,
+// and blocking one only searches when the cell may have cut its region in two. That
+// search runs from each side at once and stops as soon as all but one side have either
+// met or run out of cells, so it costs about the size of the smaller pieces.
+// Labels are kept per horizontal run of free cells, not per cell (12 bytes a run; an
+// open 10k x 10k map has 10k runs), and every update walks runs rather than cells.
+class ComponentIndex {
+public:
+    ComponentIndex();
+    // Copies the labels only, not the scratch space used for updates
+    ComponentIndex(const ComponentIndex& other);
+    ComponentIndex& operator=(const ComponentIndex& other);
+
+    void build(const Grid& grid);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // Label of a cell index, 0 for obstacles; a binary search in the cell's row
+    int get(int index) const;
+    // Number of cells with a label
+    int getSize(int label) const { return sizes[label]; }
+    // Number of separate regions
+    size_t getCount() const { return sizes.size() - 1 - freeLabels.size(); }
+
+    // Called by the grid after the cell changed state
+    void onBlocked(int x, int y);
+    void onFreed(int x, int y);
+private:
+    // A horizontal run of free cells [x0, x1) of one row; runs are never adjacent
+    struct Run {
+        int x0, x1;
+        int label;
+    };
+    // A run by position: rows[y][run]
+    struct RunRef {
+        int y;
+        int run;
+    };
+
+    // Position in rows[y] of the run holding (x, y), -1 for an obstacle
+    int findRun(int x, int y) const;
+    // First run of row y that ends after x0; the runs overlapping [x0, x1) follow it
+    int firstOverlap(int y, int x0) const;
+    int newLabel();
+    void releaseLabel(int label);
+    // Give every run of the region around at (currently labelled from) the label to
+    void relabel(RunRef at, int from, int to);
+
+    int width;
+    int height;
+    bool built;
+    std::vector<std::vector<Run>> rows; // per row, in order of x
+    std::vector<int> sizes;      // per label; label 0 is unused
+    std::vector<int> freeLabels; // labels of regions that have disappeared, for reuse
+
+    // Scratch for the searches, never copied. marks only holds the runs the current
+    // split search has reached (keyed by the index of their first cell), so it stays
+    // the size of the largest search rather than of the grid.
+    std::unordered_map<std::int64_t, int> marks; // side that reached each run
+    std::vector<RunRef> queues[4];
+};
@@ -0,0 +1,213 @@
+#include "DStarLite.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+    const int INF = INT_MAX / 2;
+}
+
+DStarLite::DStarLite(Grid& grid)
+    : grid(grid), width(grid.getWidth()), height(grid.getHeight()), active(false),
+      startIndex(-1), goalIndex(-1), lastStart(-1), km(0), expanded(0),
+      limited(false), stopped(false), cancelled(nullptr) {
+    grid.addObserver(this);
+}
+
+DStarLite::~DStarLite() {
+    grid.removeObserver(this);
+}
+
+void DStarLite::plan(const Node& start, const Node& goal) {
+    size_t cells = static_cast<size_t>(width) * height;
+    g.assign(cells, INF);
+    rhs.assign(cells, INF);
+    queue.reset(static_cast<int>(cells));
+    changed.clear();
+
+    startIndex = start.y * width + start.x;
+    goalIndex = goal.y * width + goal.x;
+    lastStart = startIndex;
+    km = 0;
+    active = true;
+
+    rhs[goalIndex] = 0;
+    queue.push(goalIndex, key1(goalIndex), -key2(goalIndex));
+}
+
+void DStarLite::setStart(const Node& start) {
+    startIndex = start.y * width + start.x;
+    km += heuristic(lastStart, startIndex);
+    lastStart = startIndex;
+}
+
+void DStarLite::clear() {
+    active = false;
+    changed.clear();
+}
+
+void DStarLite::setStopCondition(const std::atomic<bool>* cancelled, std::chrono::steady_clock::time_point deadline) {
+    this->cancelled = cancelled;
+    this->deadline = deadline;
+    limited = true;
+}
+
+void DStarLite::clearStopCondition() {
+    cancelled = nullptr;
+    limited = false;
+}
+
+void DStarLite::onCellChanged(int x, int y) {
+    if (active) {
+        changed.push_back(y * width + x);
+    }
+}
+
+std::vector<Node> DStarLite::getPath() {
+    expanded = 0;
+    stopped = false;
+    if (!active) {
+        return std::vector<Node>();
+    }
+
+    // A changed cell changes the cost of its four edges, so it and its neighbors need new rhs values
+    for (int index : changed) {
+        int x = index % width;
+        int y = index / width;
+        updateVertex(index);
+        if (x + 1 < width) updateVertex(index + 1);
+        if (y + 1 < height) updateVertex(index + width);
+        if (x > 0) updateVertex(index - 1);
+        if (y > 0) updateVertex(index - width);
+    }
+    changed.clear();
+    if (!computeShortestPath()) {
+        return std::vector<Node>();
+    }
+
+    if (g[startIndex] >= INF || !grid.isPassable(startIndex % width, startIndex / width)) {
+        return std::vector<Node>();
+    }
+
+    // Follow the cheapest neighbor down to the goal
+    std::vector<Node> path;
+    int current = startIndex;
+    Node node(current % width, current / width);
+    path.push_back(node);
+    while (current != goalIndex) {
+        int x = current % width;
+        int y = current / width;
+        unsigned passable = grid.passableNeighbors4(x, y);
+        int neighbors[4] = { current + 1, current + width, current - 1, current - width };
+        int best = -1;
+        int bestCost = INF;
+        for (int i = 0; i < 4; ++i) {
+            if ((passable & (1u << i)) && g[neighbors[i]] + grid.getStepCost(neighbors[i]) < bestCost) {
+                best = neighbors[i];
+                bestCost = g[best] + grid.getStepCost(best);
+            }
+        }
+        if (best < 0 || path.size() > g.size()) {
+            return std::vector<Node>();
+        }
+        current = best;
+        node.x = current % width;
+        node.y = current / width;
+        node.g += grid.getStepCost(current);
+        path.push_back(node);
+    }
+    return path;
+}
+
+int DStarLite::heuristic(int a, int b) const {
+    return std::abs(a % width - b % width) + std::abs(a / width - b / width);
+}
+
+int DStarLite::key2(int index) const {
+    return std::min(g[index], rhs[index]);
+}
+
+int DStarLite::key1(int index) const {
+    int k2 = key2(index);
+    return k2 >= INF ? INF : k2 + heuristic(startIndex, index) + km;
+}
+
+void DStarLite::updateVertex(int index) {
+    if (index != goalIndex) {
+        // rhs is the best one-step lookahead through a free neighbor, paying for entering it
+        int best = INF;
+        int x = index % width;
+        int y = index / width;
+        if (grid.isPassable(x, y)) {
+            unsigned passable = grid.passableNeighbors4(x, y);
+            int neighbors[4] = { index + 1, index + width, index - 1, index - width };
+            for (int i = 0; i < 4; ++i) {
+                if ((passable & (1u << i)) && g[neighbors[i]] + grid.getStepCost(neighbors[i]) < best) {
+                    best = g[neighbors[i]] + grid.getStepCost(neighbors[i]);
+                }
+            }
+        }
+        rhs[index] = best;
+    }
+
+    bool queued = queue.contains(index);
+    if (g[index] != rhs[index]) {
+        if (queued) {
+            queue.update(index, key1(index), -key2(index));
+        }
+        else {
+            queue.push(index, key1(index), -key2(index));
+        }
+    }
+    else if (queued) {
+        queue.remove(index);
+    }
+}
+
+bool DStarLite::computeShortestPath() {
+    while (!queue.empty()) {
+        const OpenEntry& top = queue.top();
+        int startKey1 = key1(startIndex);
+        int startKey2 = key2(startIndex);
+        bool topBeforeStart = top.f < startKey1 || (top.f == startKey1 && -top.g < startKey2);
+        if (!topBeforeStart && rhs[startIndex] == g[startIndex]) {
+            break;
+        }
+
+        int index = top.index;
+        int oldKey1 = top.f;
+        int oldKey2 = -top.g;
+        int newKey1 = key1(index);
+        int newKey2 = key2(index);
+        if (limited && (expanded & (STOP_CHECK_INTERVAL - 1)) == 0 && expanded > 0) {
+            // Every cell still out of date stays queued, so stopping here loses nothing
+            if ((cancelled && cancelled->load(std::memory_order_relaxed)) || std::chrono::steady_clock::now() >= deadline) {
+                stopped = true;
+                return false;
+            }
+        }
+        ++expanded;
+        if (oldKey1 < newKey1 || (oldKey1 == newKey1 && oldKey2 < newKey2)) {
+            // Queued before the start moved; requeue with its current key
+            queue.update(index, newKey1, -newKey2);
+            continue;
+        }
+
+        queue.pop();
+        if (g[index] > rhs[index]) {
+            g[index] = rhs[index];
+        }
+        else {
+            g[index] = INF;
+            updateVertex(index);
+        }
+
+        int x = index % width;
+        int y = index / width;
+        if (x + 1 < width) updateVertex(index + 1);
+        if (y + 1 < height) updateVertex(index + width);
+        if (x > 0) updateVertex(index - 1);
+        if (y > 0) updateVertex(index - width);
+    }
+    return true;
+}
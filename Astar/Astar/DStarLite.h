@@ -0,0 +1,74 @@
+#pragma once
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "Pathfinding.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Incremental planner (D* Lite) for one start/goal pair on a 4-connected grid, with the
+// grid's terrain costs (a step costs what the cell it enters costs).
+// It searches backwards from the goal and keeps its g/rhs values between calls.
+// When cells change it only re-expands the cells whose distance to the goal
+// actually changed, instead of searching again from scratch. Edits arrive through
+// the Grid observer hook and are applied on the next getPath().
+class DStarLite : public GridObserver {
+public:
+    explicit DStarLite(Grid& grid);
+    ~DStarLite();
+    DStarLite(const DStarLite&) = delete;
+    DStarLite& operator=(const DStarLite&) = delete;
+
+    // Start a new query; the first getPath() does the full search
+    void plan(const Node& start, const Node& goal);
+    // The agent moved along (or off) the path; the search state is kept
+    void setStart(const Node& start);
+    // Forget the current query
+    void clear();
+    bool isActive() const { return active; }
+
+    // Repair the search for any edits since the last call, then return the path
+    // from start to goal (empty when the goal cannot be reached)
+    std::vector<Node> getPath();
+    void onCellChanged(int x, int y) override;
+
+    // Optional stop conditions, as in SearchState: getPath() polls them every
+    // STOP_CHECK_INTERVAL expansions and returns no path once either trips. The repair done
+    // so far is kept, so the next getPath() carries on where it stopped.
+    void setStopCondition(const std::atomic<bool>* cancelled, std::chrono::steady_clock::time_point deadline);
+    void clearStopCondition();
+    // Whether the last getPath() gave up because of the stop condition
+    bool wasStopped() const { return stopped; }
+
+    // Cells expanded by the last getPath()
+    size_t getExpanded() const { return expanded; }
+private:
+    static const size_t STOP_CHECK_INTERVAL = 256; // power of two
+
+    // Queue keys are (k1, k2), compared in that order. The heap breaks ties towards the
+    // larger g, so k2 is stored negated.
+    int key1(int index) const;
+    int key2(int index) const;
+    int heuristic(int a, int b) const;
+    void updateVertex(int index);
+    // False when the stop condition tripped before the start was settled
+    bool computeShortestPath();
+
+    Grid& grid;
+    int width;
+    int height;
+    bool active;
+    int startIndex;
+    int goalIndex;
+    int lastStart; // start when km was last brought up to date
+    int km;        // key modifier that keeps old keys valid after the start moves
+    std::vector<int> g;
+    std::vector<int> rhs;
+    IndexedHeap<4> queue;
+    std::vector<int> changed;
+    size_t expanded;
+    bool limited;
+    bool stopped;
+    const std::atomic<bool>* cancelled;
+    std::chrono::steady_clock::time_point deadline;
+};
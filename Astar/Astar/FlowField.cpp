@@ -0,0 +1,279 @@
+#include "FlowField.h"
+#include <algorithm>
+
+namespace {
+    const int UNREACHED = 1 << 29;
+    // Neighbor offsets in the order of the Grid::RIGHT, DOWN, LEFT, UP bits
+    const int DX[4] = { 1, 0, -1, 0 };
+    const int DY[4] = { 0, 1, 0, -1 };
+    // Direction that points back from each of those neighbors
+    const unsigned BACK[4] = { Grid::LEFT, Grid::UP, Grid::RIGHT, Grid::DOWN };
+}
+
+FlowField::FlowField(Grid& grid)
+    : grid(grid), width(0), height(0), stride(0), built(false), destination(0, 0) {
+    grid.addObserver(this);
+}
+
+FlowField::~FlowField() {
+    grid.removeObserver(this);
+}
+
+bool FlowField::build(const Node& destination) {
+    clear();
+    if (destination.x < 0 || destination.y < 0 || destination.x >= grid.getWidth() || destination.y >= grid.getHeight()) {
+        return false;
+    }
+    width = grid.getWidth();
+    height = grid.getHeight();
+    stride = width + 2;
+    int cells = stride * (height + 2);
+    distance.assign(cells, UNREACHED);
+    via.assign(cells, UNREACHED);
+    directions.assign(static_cast<size_t>(width) * height, 0);
+    this->destination = Node(destination.x, destination.y);
+    built = true;
+
+    if (grid.isPassable(destination.x, destination.y)) {
+        int index = padded(destination.x, destination.y);
+        distance[index] = 0;
+        via[index] = grid.getStepCost(destination.y * width + destination.x);
+        queue.reset(cells);
+        queue.push(index, 0, 0);
+        propagate();
+    }
+    touched.clear();
+    for (int y = 0; y < height; ++y) {
+        updateDirections(y, 0, width);
+    }
+    return true;
+}
+
+void FlowField::clear() {
+    built = false;
+    distance.clear();
+    via.clear();
+    directions.clear();
+}
+
+int FlowField::getDistance(int x, int y) const {
+    if (!built || x < 0 || y < 0 || x >= width || y >= height) {
+        return -1;
+    }
+    int d = distance[padded(x, y)];
+    return d < UNREACHED ? d : -1;
+}
+
+unsigned FlowField::getDirection(int x, int y) const {
+    if (!built || x < 0 || y < 0 || x >= width || y >= height) {
+        return 0;
+    }
+    return directions[y * width + x];
+}
+
+bool FlowField::nextStep(const Node& from, Node& next) const {
+    unsigned direction = getDirection(from.x, from.y);
+    for (int k = 0; k < 4; ++k) {
+        if (direction == 1u << k) {
+            next = Node(from.x + DX[k], from.y + DY[k]);
+            next.g = from.g + grid.getStepCost(next.y * width + next.x);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Node> FlowField::pathFrom(const Node& start) const {
+    std::vector<Node> path;
+    if (getDistance(start.x, start.y) < 0) {
+        return path;
+    }
+    path.push_back(Node(start.x, start.y));
+    Node next(0, 0);
+    while (nextStep(path.back(), next)) {
+        path.push_back(next);
+    }
+    return path;
+}
+
+void FlowField::onCellChanged(int x, int y) {
+    if (!built) {
+        return;
+    }
+    if (grid.getWidth() != width || grid.getHeight() != height) {
+        clear(); // assigned another grid
+        return;
+    }
+    int index = padded(x, y);
+    if (distance[index] >= UNREACHED) {
+        if (grid.isPassable(x, y)) {
+            lower(x, y); // freed, or a cost change on a cell nothing reaches
+        }
+        return;
+    }
+    int now = grid.isPassable(x, y) ? distance[index] + grid.getStepCost(y * width + x) : UNREACHED;
+    if (now > via[index]) {
+        raise(x, y);
+    }
+    else if (now < via[index]) {
+        lower(x, y);
+    }
+}
+
+void FlowField::propagate() {
+    while (!queue.empty()) {
+        OpenEntry current = queue.pop();
+        int x = current.index % stride - 1;
+        int y = current.index / stride - 1;
+        int step = via[current.index];
+        unsigned open = grid.passableNeighbors4(x, y);
+        for (int k = 0; k < 4; ++k) {
+            if (!(open & (1u << k))) {
+                continue;
+            }
+            int nx = x + DX[k];
+            int ny = y + DY[k];
+            int neighbor = padded(nx, ny);
+            if (step >= distance[neighbor]) {
+                continue;
+            }
+            distance[neighbor] = step;
+            via[neighbor] = step + grid.getStepCost(ny * width + nx);
+            touched.push_back(neighbor);
+            if (queue.contains(neighbor)) {
+                queue.decreaseKey(neighbor, step, step);
+            }
+            else {
+                queue.push(neighbor, step, step);
+            }
+        }
+    }
+}
+
+void FlowField::lower(int x, int y) {
+    int index = padded(x, y);
+    int best = x == destination.x && y == destination.y ? 0 : distance[index];
+    unsigned open = grid.passableNeighbors4(x, y);
+    for (int k = 0; k < 4; ++k) {
+        if (open & (1u << k)) {
+            best = std::min(best, via[padded(x + DX[k], y + DY[k])]);
+        }
+    }
+    touched.clear();
+    if (best < UNREACHED) {
+        distance[index] = best;
+        via[index] = best + grid.getStepCost(y * width + x);
+        touched.push_back(index);
+        queue.reset(stride * (height + 2));
+        queue.push(index, best, best);
+        propagate();
+    }
+    updateTouched();
+}
+
+void FlowField::raise(int x, int y) {
+    int index = padded(x, y);
+    touched.clear();
+    touched.push_back(index);
+    if (grid.isPassable(x, y)) {
+        via[index] = distance[index] + grid.getStepCost(y * width + x); // leaving it costs the same
+    }
+    else {
+        distance[index] = UNREACHED;
+        via[index] = UNREACHED;
+    }
+
+    // Every cell whose steps pass through (x, y) loses its distance. The directions still
+    // describe the old field here, so they give the cells that stepped into each one.
+    stack.clear();
+    stack.push_back(index);
+    while (!stack.empty()) {
+        int cell = stack.back();
+        stack.pop_back();
+        int cx = cell % stride - 1;
+        int cy = cell / stride - 1;
+        unsigned open = grid.passableNeighbors4(cx, cy);
+        for (int k = 0; k < 4; ++k) {
+            int nx = cx + DX[k];
+            int ny = cy + DY[k];
+            if ((open & (1u << k)) && directions[ny * width + nx] == BACK[k]) {
+                int neighbor = padded(nx, ny);
+                distance[neighbor] = UNREACHED;
+                via[neighbor] = UNREACHED;
+                touched.push_back(neighbor);
+                stack.push_back(neighbor);
+            }
+        }
+    }
+
+    if (touched.size() > static_cast<size_t>(width) * height / 4) {
+        // Most of the field hung off this cell (common in mazes); starting over is cheaper
+        Node target = destination;
+        build(target);
+        return;
+    }
+
+    // Reseed them from whichever neighbors still have a way to the destination
+    queue.reset(stride * (height + 2));
+    size_t reset = touched.size();
+    for (size_t i = 1; i < reset; ++i) {
+        int cell = touched[i];
+        int cx = cell % stride - 1;
+        int cy = cell / stride - 1;
+        int best = UNREACHED;
+        unsigned open = grid.passableNeighbors4(cx, cy);
+        for (int k = 0; k < 4; ++k) {
+            if (open & (1u << k)) {
+                best = std::min(best, via[padded(cx + DX[k], cy + DY[k])]);
+            }
+        }
+        if (best < UNREACHED) {
+            distance[cell] = best;
+            via[cell] = best + grid.getStepCost(cy * width + cx);
+            queue.push(cell, best, best);
+        }
+    }
+    propagate();
+    updateTouched();
+}
+
+void FlowField::updateDirections(int y, int x0, int x1) {
+    const int* row = &distance[padded(0, y)];
+    const int* right = &via[padded(1, y)];
+    const int* left = &via[padded(-1, y)];
+    const int* below = &via[padded(0, y + 1)];
+    const int* above = &via[padded(0, y - 1)];
+    std::uint8_t* out = &directions[static_cast<size_t>(y) * width];
+    // Selects rather than branches, so the loop vectorises. The cheapest neighbor's via is
+    // the cell's own distance; the destination, obstacles and unreachable cells get 0.
+    for (int x = x0; x < x1; ++x) {
+        int best = right[x];
+        unsigned direction = Grid::RIGHT;
+        direction = below[x] < best ? Grid::DOWN : direction;
+        best = below[x] < best ? below[x] : best;
+        direction = left[x] < best ? Grid::LEFT : direction;
+        best = left[x] < best ? left[x] : best;
+        direction = above[x] < best ? Grid::UP : direction;
+        out[x] = static_cast<std::uint8_t>(row[x] > 0 && row[x] < UNREACHED ? direction : 0);
+    }
+}
+
+void FlowField::updateTouched() {
+    if (touched.size() > static_cast<size_t>(width) * height / 8) {
+        for (int y = 0; y < height; ++y) {
+            updateDirections(y, 0, width);
+        }
+        return;
+    }
+    for (int cell : touched) {
+        int x = cell % stride - 1;
+        int y = cell / stride - 1;
+        updateDirections(y, std::max(x - 1, 0), std::min(x + 2, width));
+        if (y > 0) {
+            updateDirections(y - 1, x, x + 1);
+        }
+        if (y + 1 < height) {
+            updateDirections(y + 1, x, x + 1);
+        }
+    }
+}
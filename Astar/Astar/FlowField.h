@@ -0,0 +1,69 @@
+#pragma once
+#include "BucketQueue.h"
+#include "Grid.h"
+#include "Pathfinding.h"
+#include <cstdint>
+#include <vector>
+
+// Distance to one shared destination from every cell, and the 4-connected step towards
+// it, for crowds where many agents head to the same place. One reverse Dijkstra from the
+// destination (terrain costs included) replaces a search per agent; each agent then reads
+// its next step in O(1). Directions are derived from the distances a row at a time,
+// branch-free over padded rows so the compiler can vectorise the pass.
+// Edits arrive through the Grid observer hook and are repaired in place:
+//  - a cell that gets freed or cheaper pushes the shorter distances outwards from it;
+//  - a cell that gets blocked or dearer resets only the cells whose steps led through
+//    it, reseeds them from their neighbors and settles them again.
+// Not thread-safe.
+class FlowField : public GridObserver {
+public:
+    explicit FlowField(Grid& grid);
+    ~FlowField();
+    FlowField(const FlowField&) = delete;
+    FlowField& operator=(const FlowField&) = delete;
+
+    // Fill the field towards destination; false (leaving the field empty) when it is outside the grid
+    bool build(const Node& destination);
+    void clear();
+    bool isBuilt() const { return built; }
+    const Node& getDestination() const { return destination; }
+
+    // Cost of the cheapest path from (x, y) to the destination, -1 when there is none
+    int getDistance(int x, int y) const;
+    // Grid::RIGHT, DOWN, LEFT or UP towards the destination; 0 at the destination, on
+    // obstacles and where it cannot be reached
+    unsigned getDirection(int x, int y) const;
+    // The cell after from on a cheapest path, with g advanced by its cost; false where
+    // getDirection() is 0
+    bool nextStep(const Node& from, Node& next) const;
+    // Whole path from start, as Pathfinding::findPath returns it; empty when unreachable
+    std::vector<Node> pathFrom(const Node& start) const;
+
+    void onCellChanged(int x, int y) override;
+private:
+    // Index into the padded arrays, which have a border of unreachable cells all round
+    int padded(int x, int y) const { return (y + 1) * stride + x + 1; }
+    // Settle the queued cells and everything they lower, recording each change in touched
+    void propagate();
+    // Relax a cell from its neighbors and propagate; for cells freed or made cheaper
+    void lower(int x, int y);
+    // Reset the cells whose steps lead through (x, y) and settle them again
+    void raise(int x, int y);
+    // Directions of cells [x0, x1) in row y from the distances around them
+    void updateDirections(int y, int x0, int x1);
+    // Directions of the touched cells and their neighbors
+    void updateTouched();
+
+    Grid& grid;
+    int width;
+    int height;
+    int stride;
+    bool built;
+    Node destination;
+    std::vector<int> distance;            // padded; UNREACHED on obstacles and the border
+    std::vector<int> via;                 // padded; distance plus the cost of entering the cell
+    std::vector<std::uint8_t> directions; // width * height
+    BucketQueue<512> queue;               // padded indices
+    std::vector<int> touched;             // padded indices
+    std::vector<int> stack;
+};
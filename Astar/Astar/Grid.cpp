@@ -1,24 +1,234 @@
-#include "Grid.h"
-
-Grid::Grid(int width, int height) : width(width), height(height) {
-    data.resize(height, std::vector<int>(width, 0));
-}
-
-void Grid::setObstacle(int x, int y) {
-    if (x >= 0 && x < width && y >= 0 && y < height) {
-        data[y][x] = 1;
-    }
-}
-
-void Grid::clearObstacle(int x, int y) {
-    if (x >= 0 && x < width && y >= 0 && y < height) {
-        data[y][x] = 0;
-    }
-}
-
-bool Grid::isObstacle(int x, int y) const {
-    if (x >= 0 && x < width && y >= 0 && y < height) {
-        return data[y][x] == 1;
-    }
-    return false;
-}
+#include "Grid.h"
+#include "Bits.h"
+#include <algorithm>
+
+Grid::Grid(int width, int height) : width(width), height(height), wordsPerRow((width + 63) / 64), version(0) {
+    data.resize(static_cast<size_t>(wordsPerRow) * height, 0);
+
+    // Mark the padding past the right edge of each row as obstacles
+    int used = width % 64;
+    if (used != 0) {
+        std::uint64_t padding = ~0ULL << used;
+        for (int y = 0; y < height; ++y) {
+            data[static_cast<size_t>(y) * wordsPerRow + wordsPerRow - 1] = padding;
+        }
+    }
+}
+
+Grid::Grid(const Grid& other)
+    : width(other.width), height(other.height), wordsPerRow(other.wordsPerRow), version(0), data(other.data), costs(other.costs),
+      components(other.components) {}
+
+Grid& Grid::operator=(const Grid& other) {
+    width = other.width;
+    height = other.height;
+    wordsPerRow = other.wordsPerRow;
+    data = other.data;
+    costs = other.costs;
+    components = other.components;
+    changed();
+    return *this;
+}
+
+void Grid::setObstacle(int x, int y) {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        std::uint64_t& word = data[static_cast<size_t>(y) * wordsPerRow + (x >> 6)];
+        std::uint64_t bit = 1ULL << (x & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            if (components.isBuilt()) {
+                components.onBlocked(x, y);
+            }
+            changed();
+            notify(x, y);
+        }
+    }
+}
+
+void Grid::clearObstacle(int x, int y) {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        std::uint64_t& word = data[static_cast<size_t>(y) * wordsPerRow + (x >> 6)];
+        std::uint64_t bit = 1ULL << (x & 63);
+        if (word & bit) {
+            word &= ~bit;
+            if (components.isBuilt()) {
+                components.onFreed(x, y);
+            }
+            changed();
+            notify(x, y);
+        }
+    }
+}
+
+void Grid::setCost(int x, int y, int cost) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return;
+    }
+    if (cost <= 0) {
+        setObstacle(x, y);
+        return;
+    }
+    if (cost > MAX_COST) {
+        cost = MAX_COST;
+    }
+    if (costs.empty()) {
+        if (cost == 1) {
+            clearObstacle(x, y);
+            return;
+        }
+        costs.assign(static_cast<size_t>(width) * height, 1);
+    }
+    std::uint8_t& stored = costs[static_cast<size_t>(y) * width + x];
+    bool different = stored != cost;
+    stored = static_cast<std::uint8_t>(cost);
+    if (isObstacle(x, y)) {
+        clearObstacle(x, y); // notifies
+    }
+    else if (different) {
+        changed();
+        notify(x, y);
+    }
+}
+
+int Grid::getCost(int x, int y) const {
+    if (!isPassable(x, y)) {
+        return 0;
+    }
+    return getStepCost(y * width + x);
+}
+
+bool Grid::isObstacle(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        return (data[static_cast<size_t>(y) * wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+    }
+    return false;
+}
+
+bool Grid::isPassable(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        return !((data[static_cast<size_t>(y) * wordsPerRow + (x >> 6)] >> (x & 63)) & 1);
+    }
+    return false;
+}
+
+void Grid::buildComponents() {
+    components.build(*this);
+    shared.reset(); // same cells, but a snapshot would lack the labels
+}
+
+std::shared_ptr<const Grid> Grid::snapshot() const {
+    if (!shared) {
+        shared = std::make_shared<const Grid>(*this);
+    }
+    return shared;
+}
+
+void Grid::changed() {
+    ++version;
+    shared.reset();
+}
+
+bool Grid::isReachable(int x0, int y0, int x1, int y1) const {
+    if (!isPassable(x0, y0) || !isPassable(x1, y1)) {
+        return false;
+    }
+    return !components.isBuilt() || components.get(y0 * width + x0) == components.get(y1 * width + x1);
+}
+
+unsigned Grid::passableNeighbors4(int x, int y) const {
+    // Three cells of the row above, the row itself and the row below, starting at x - 1
+    unsigned above = static_cast<unsigned>(~rowBits(x - 1, y - 1)) & 7;
+    unsigned row = static_cast<unsigned>(~rowBits(x - 1, y)) & 7;
+    unsigned below = static_cast<unsigned>(~rowBits(x - 1, y + 1)) & 7;
+
+    return ((row >> 2) & 1) * RIGHT
+        | ((below >> 1) & 1) * DOWN
+        | (row & 1) * LEFT
+        | ((above >> 1) & 1) * UP;
+}
+
+unsigned Grid::passableNeighbors8(int x, int y) const {
+    unsigned above = static_cast<unsigned>(~rowBits(x - 1, y - 1)) & 7;
+    unsigned below = static_cast<unsigned>(~rowBits(x - 1, y + 1)) & 7;
+
+    return passableNeighbors4(x, y)
+        | ((below >> 2) & 1) * DOWN_RIGHT
+        | (below & 1) * DOWN_LEFT
+        | (above & 1) * UP_LEFT
+        | ((above >> 2) & 1) * UP_RIGHT;
+}
+
+int Grid::nextObstacleInRow(int x, int y) const {
+    if (y < 0 || y >= height || x >= width) {
+        return width;
+    }
+    if (x < 0) {
+        x = 0;
+    }
+    const std::uint64_t* row = &data[static_cast<size_t>(y) * wordsPerRow];
+    int word = x >> 6;
+    std::uint64_t bits = row[word] & (~0ULL << (x & 63));
+    while (bits == 0) {
+        if (++word == wordsPerRow) {
+            return width;
+        }
+        bits = row[word];
+    }
+    int found = word * 64 + countTrailingZeros(bits);
+    return found < width ? found : width;
+}
+
+int Grid::prevObstacleInRow(int x, int y) const {
+    if (y < 0 || y >= height || x < 0) {
+        return -1;
+    }
+    if (x >= width) {
+        x = width - 1;
+    }
+    const std::uint64_t* row = &data[static_cast<size_t>(y) * wordsPerRow];
+    int word = x >> 6;
+    std::uint64_t bits = row[word] & (~0ULL >> (63 - (x & 63)));
+    while (bits == 0) {
+        if (word-- == 0) {
+            return -1;
+        }
+        bits = row[word];
+    }
+    return word * 64 + 63 - countLeadingZeros(bits);
+}
+
+std::uint64_t Grid::rowBits(int x, int y) const {
+    if (y < 0 || y >= height || x >= width) {
+        return ~0ULL;
+    }
+    if (x < 0) {
+        if (x <= -64) {
+            return ~0ULL;
+        }
+        // Shift the row start up and fill the cells left of the grid with obstacles
+        return (rowBits(0, y) << -x) | ((1ULL << -x) - 1);
+    }
+    const std::uint64_t* row = &data[static_cast<size_t>(y) * wordsPerRow];
+    int word = x >> 6;
+    int offset = x & 63;
+    std::uint64_t bits = row[word] >> offset;
+    if (offset != 0) {
+        std::uint64_t next = word + 1 < wordsPerRow ? row[word + 1] : ~0ULL;
+        bits |= next << (64 - offset);
+    }
+    return bits;
+}
+
+void Grid::addObserver(GridObserver* observer) {
+    observers.push_back(observer);
+}
+
+void Grid::removeObserver(GridObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void Grid::notify(int x, int y) {
+    for (GridObserver* observer : observers) {
+        observer->onCellChanged(x, y);
+    }
+}
@@ -1,16 +1,94 @@
-#pragma once
-#include <vector>
-
-class Grid {
-public:
-    Grid(int width, int height);
-    void setObstacle(int x, int y);
-    void clearObstacle(int x, int y);
-    bool isObstacle(int x, int y) const;
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
-private:
-    int width;
-    int height;
-    std::vector<std::vector<int>> data;
-};
+#pragma once
+#include "ComponentIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Receives a call whenever a cell of a Grid it is registered with changes state
+class GridObserver {
+public:
+    virtual ~GridObserver() {}
+    virtual void onCellChanged(int x, int y) = 0;
+};
+
+// Obstacle map stored as one bit per cell (1 = obstacle) in a single buffer of
+// 64-bit words. Every row starts on a word boundary and the padding bits past
+// the right edge are set, so row scans stop at the edge on their own.
+class Grid {
+public:
+    // Neighbor bits returned by passableNeighbors4/8
+    static const unsigned RIGHT = 1;
+    static const unsigned DOWN = 2;
+    static const unsigned LEFT = 4;
+    static const unsigned UP = 8;
+    static const unsigned DOWN_RIGHT = 16;
+    static const unsigned DOWN_LEFT = 32;
+    static const unsigned UP_LEFT = 64;
+    static const unsigned UP_RIGHT = 128;
+    static const int MAX_COST = 255;
+
+    Grid(int width, int height);
+    // Copies the cells and component labels; observers stay registered with the original
+    Grid(const Grid& other);
+    Grid& operator=(const Grid& other);
+    void setObstacle(int x, int y);
+    void clearObstacle(int x, int y);
+    // Cost of entering a cell, 1 to MAX_COST (larger values are clamped); 0 or less makes it an
+    // obstacle. A positive cost on an obstacle frees it. Obstacles keep the cost underneath, so
+    // clearing one brings it back. No cost array is allocated until some cell costs more than 1.
+    void setCost(int x, int y, int cost);
+    // 0 for obstacles and cells outside the grid
+    int getCost(int x, int y) const;
+    // Cost of entering the free cell at index, unchecked
+    int getStepCost(int index) const { return costs.empty() ? 1 : costs[index]; }
+    // Whether any cell has ever had a cost other than 1
+    bool hasCosts() const { return !costs.empty(); }
+    bool isObstacle(int x, int y) const;
+    // Inside the grid and not an obstacle
+    bool isPassable(int x, int y) const;
+    // Mask of the passable 4 (or 8) neighbors of a cell
+    unsigned passableNeighbors4(int x, int y) const;
+    unsigned passableNeighbors8(int x, int y) const;
+    // First obstacle at or right of x in row y, or width if there is none
+    int nextObstacleInRow(int x, int y) const;
+    // Last obstacle at or left of x in row y, or -1 if there is none
+    int prevObstacleInRow(int x, int y) const;
+    // Obstacle bits of cells x..x+63 in row y (bit 0 = cell x); cells outside the grid read as obstacles
+    std::uint64_t rowBits(int x, int y) const;
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Label the 4-connected regions of free cells; from then on every edit keeps the labels current
+    void buildComponents();
+    bool hasComponents() const { return components.isBuilt(); }
+    // Region label of a cell (0 for obstacles); needs buildComponents()
+    int getComponent(int x, int y) const { return components.get(y * width + x); }
+    const ComponentIndex& getComponents() const { return components; }
+    // False when (x1, y1) certainly cannot be reached from (x0, y0) by 4-connected moves (or
+    // diagonal moves that do not cut corners). Without component labels only the two cells are checked.
+    bool isReachable(int x0, int y0, int x1, int y1) const;
+    // Bumped by every change to the cells, including assignment from another grid
+    std::uint64_t getVersion() const { return version; }
+    // Read-only copy of the grid as it is now (cells, costs and component labels), made on
+    // the first call and shared by every call until the next change; for handing the grid
+    // to other threads without copying it per job
+    std::shared_ptr<const Grid> snapshot() const;
+
+    // Observers are told about every cell that setObstacle/clearObstacle/setCost actually changes
+    void addObserver(GridObserver* observer);
+    void removeObserver(GridObserver* observer);
+private:
+    void notify(int x, int y);
+    // Called on every change, with notify() where a single cell changed
+    void changed();
+
+    int width;
+    int height;
+    int wordsPerRow;
+    std::uint64_t version;
+    std::vector<std::uint64_t> data;
+    std::vector<std::uint8_t> costs; // per cell, empty while every cell costs 1
+    ComponentIndex components;
+    std::vector<GridObserver*> observers;
+    mutable std::shared_ptr<const Grid> shared; // snapshot() of this version, never copied
+};
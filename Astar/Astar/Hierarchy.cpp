@@ -0,0 +1,372 @@
+#include "Hierarchy.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    // Runs of free border cells at least this long get a transition at each end instead of one in the middle
+    const int LONG_ENTRANCE = 6;
+}
+
+Hierarchy::Hierarchy(Grid& grid, int clusterSize) : grid(grid), clusterSize(clusterSize) {
+    clustersX = (grid.getWidth() + clusterSize - 1) / clusterSize;
+    clustersY = (grid.getHeight() + clusterSize - 1) / clusterSize;
+    build();
+    grid.addObserver(this);
+}
+
+Hierarchy::~Hierarchy() {
+    grid.removeObserver(this);
+}
+
+void Hierarchy::build() {
+    int count = clustersX * clustersY;
+    clusters.assign(count, Cluster());
+    verticalBorders.assign(count, std::vector<Transition>());
+    horizontalBorders.assign(count, std::vector<Transition>());
+
+    for (int c = 0; c < count; ++c) {
+        Cluster& cluster = clusters[c];
+        cluster.x0 = (c % clustersX) * clusterSize;
+        cluster.y0 = (c / clustersX) * clusterSize;
+        cluster.x1 = std::min(cluster.x0 + clusterSize, grid.getWidth());
+        cluster.y1 = std::min(cluster.y0 + clusterSize, grid.getHeight());
+    }
+    for (int c = 0; c < count; ++c) {
+        buildVerticalBorder(c);
+        buildHorizontalBorder(c);
+    }
+    for (int c = 0; c < count; ++c) {
+        buildCluster(c);
+    }
+}
+
+size_t Hierarchy::getNodeCount() const {
+    size_t count = 0;
+    for (const Cluster& cluster : clusters) {
+        count += cluster.nodes.size();
+    }
+    return count;
+}
+
+void Hierarchy::onCellChanged(int x, int y) {
+    int c = clusterOf(x, y);
+    const Cluster& cluster = clusters[c];
+    int cx = c % clustersX;
+    int cy = c / clustersX;
+
+    // Interior cells only change their own cluster; border cells also change the transitions
+    // shared with the neighbor, and with them that neighbor's nodes
+    int affected[5] = { c };
+    int count = 1;
+    if (x == cluster.x0 && cx > 0) {
+        buildVerticalBorder(c - 1);
+        affected[count++] = c - 1;
+    }
+    if (x == cluster.x1 - 1 && cx < clustersX - 1) {
+        buildVerticalBorder(c);
+        affected[count++] = c + 1;
+    }
+    if (y == cluster.y0 && cy > 0) {
+        buildHorizontalBorder(c - clustersX);
+        affected[count++] = c - clustersX;
+    }
+    if (y == cluster.y1 - 1 && cy < clustersY - 1) {
+        buildHorizontalBorder(c);
+        affected[count++] = c + clustersX;
+    }
+    for (int i = 0; i < count; ++i) {
+        buildCluster(affected[i]);
+    }
+}
+
+void Hierarchy::buildVerticalBorder(int c) {
+    std::vector<Transition>& border = verticalBorders[c];
+    border.clear();
+    if (c % clustersX == clustersX - 1) {
+        return;
+    }
+
+    const Cluster& cluster = clusters[c];
+    int width = grid.getWidth();
+    int x = cluster.x1 - 1;
+    int runStart = -1;
+    for (int y = cluster.y0; y <= cluster.y1; ++y) {
+        bool open = y < cluster.y1 && grid.isPassable(x, y) && grid.isPassable(x + 1, y);
+        if (open && runStart < 0) {
+            runStart = y;
+        }
+        else if (!open && runStart >= 0) {
+            int runEnd = y - 1;
+            if (runEnd - runStart + 1 >= LONG_ENTRANCE) {
+                border.push_back({ runStart * width + x, runStart * width + x + 1 });
+                border.push_back({ runEnd * width + x, runEnd * width + x + 1 });
+            }
+            else {
+                int middle = (runStart + runEnd) / 2;
+                border.push_back({ middle * width + x, middle * width + x + 1 });
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void Hierarchy::buildHorizontalBorder(int c) {
+    std::vector<Transition>& border = horizontalBorders[c];
+    border.clear();
+    if (c / clustersX == clustersY - 1) {
+        return;
+    }
+
+    const Cluster& cluster = clusters[c];
+    int width = grid.getWidth();
+    int y = cluster.y1 - 1;
+    int runStart = -1;
+    for (int x = cluster.x0; x <= cluster.x1; ++x) {
+        bool open = x < cluster.x1 && grid.isPassable(x, y) && grid.isPassable(x, y + 1);
+        if (open && runStart < 0) {
+            runStart = x;
+        }
+        else if (!open && runStart >= 0) {
+            int runEnd = x - 1;
+            if (runEnd - runStart + 1 >= LONG_ENTRANCE) {
+                border.push_back({ y * width + runStart, (y + 1) * width + runStart });
+                border.push_back({ y * width + runEnd, (y + 1) * width + runEnd });
+            }
+            else {
+                int middle = (runStart + runEnd) / 2;
+                border.push_back({ y * width + middle, (y + 1) * width + middle });
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void Hierarchy::buildCluster(int c) {
+    Cluster& cluster = clusters[c];
+    int cx = c % clustersX;
+    int cy = c / clustersX;
+
+    cluster.nodes.clear();
+    if (cx > 0) {
+        for (const Transition& t : verticalBorders[c - 1]) cluster.nodes.push_back(t.second);
+    }
+    for (const Transition& t : verticalBorders[c]) cluster.nodes.push_back(t.first);
+    if (cy > 0) {
+        for (const Transition& t : horizontalBorders[c - clustersX]) cluster.nodes.push_back(t.second);
+    }
+    for (const Transition& t : horizontalBorders[c]) cluster.nodes.push_back(t.first);
+    // A corner cell can sit on two borders
+    std::sort(cluster.nodes.begin(), cluster.nodes.end());
+    cluster.nodes.erase(std::unique(cluster.nodes.begin(), cluster.nodes.end()), cluster.nodes.end());
+
+    size_t n = cluster.nodes.size();
+    cluster.costs.assign(n * n, -1);
+    for (size_t i = 0; i < n; ++i) {
+        searchCluster(c, cluster.nodes[i]);
+        for (size_t j = 0; j < n; ++j) {
+            if (localState.isVisited(cluster.nodes[j])) {
+                cluster.costs[i * n + j] = localState.getG(cluster.nodes[j]);
+            }
+        }
+    }
+}
+
+void Hierarchy::searchCluster(int c, int source) {
+    const Cluster& cluster = clusters[c];
+    int width = grid.getWidth();
+    localState.begin(width, grid.getHeight());
+    SearchState::BucketList& openList = localState.getBucketList();
+    openList.reset(width * grid.getHeight());
+    localState.open(source, 0, -1);
+    openList.push(source, 0, 0);
+
+    while (!openList.empty()) {
+        OpenEntry current = openList.pop();
+        localState.close(current.index);
+        int x = current.index % width;
+        int y = current.index / width;
+        unsigned passable = grid.passableNeighbors4(x, y);
+        int neighbors[4] = { current.index + 1, current.index + width, current.index - 1, current.index - width };
+        bool inside[4] = { x + 1 < cluster.x1, y + 1 < cluster.y1, x > cluster.x0, y > cluster.y0 };
+        for (int i = 0; i < 4; ++i) {
+            int neighbor = neighbors[i];
+            if (!(passable & (1u << i)) || !inside[i] || localState.isClosed(neighbor)) {
+                continue;
+            }
+            int tentative_g = current.g + grid.getStepCost(neighbor);
+            if (!localState.isOpen(neighbor)) {
+                localState.open(neighbor, tentative_g, current.index);
+                openList.push(neighbor, tentative_g, tentative_g);
+            }
+            else if (tentative_g < localState.getG(neighbor)) {
+                localState.open(neighbor, tentative_g, current.index);
+                openList.decreaseKey(neighbor, tentative_g, tentative_g);
+            }
+        }
+    }
+}
+
+void Hierarchy::appendLocalPath(int target, std::vector<Node>& path) {
+    int width = grid.getWidth();
+    size_t first = path.size();
+    int base = path.back().g;
+    for (int index = target; localState.getParent(index) != -1; index = localState.getParent(index)) {
+        Node node(index % width, index / width);
+        node.g = base + localState.getG(index);
+        path.push_back(node);
+    }
+    std::reverse(path.begin() + first, path.end());
+}
+
+void Hierarchy::getEdges(int index, std::vector<std::pair<int, int>>& edges) const {
+    int width = grid.getWidth();
+    int x = index % width;
+    int y = index / width;
+    int c = clusterOf(x, y);
+    const Cluster& cluster = clusters[c];
+    auto it = std::lower_bound(cluster.nodes.begin(), cluster.nodes.end(), index);
+    if (it == cluster.nodes.end() || *it != index) {
+        return;
+    }
+
+    // Inside the cluster
+    size_t n = cluster.nodes.size();
+    size_t i = it - cluster.nodes.begin();
+    for (size_t j = 0; j < n; ++j) {
+        int cost = cluster.costs[i * n + j];
+        if (j != i && cost >= 0) {
+            edges.push_back({ cluster.nodes[j], cost });
+        }
+    }
+
+    // Across the borders the cell sits on; a crossing costs what the cell it enters costs
+    if (x == cluster.x1 - 1) {
+        for (const Transition& t : verticalBorders[c]) if (t.first == index) edges.push_back({ t.second, grid.getStepCost(t.second) });
+    }
+    if (x == cluster.x0 && c % clustersX > 0) {
+        for (const Transition& t : verticalBorders[c - 1]) if (t.second == index) edges.push_back({ t.first, grid.getStepCost(t.first) });
+    }
+    if (y == cluster.y1 - 1) {
+        for (const Transition& t : horizontalBorders[c]) if (t.first == index) edges.push_back({ t.second, grid.getStepCost(t.second) });
+    }
+    if (y == cluster.y0 && c / clustersX > 0) {
+        for (const Transition& t : horizontalBorders[c - clustersX]) if (t.second == index) edges.push_back({ t.first, grid.getStepCost(t.first) });
+    }
+}
+
+std::vector<Node> Hierarchy::findPath(const Node& start, const Node& end) {
+    expanded = 0;
+    if (!grid.isReachable(start.x, start.y, end.x, end.y)) {
+        return std::vector<Node>();
+    }
+    int startCluster = clusterOf(start.x, start.y);
+    int endCluster = clusterOf(end.x, end.y);
+    if (std::abs(startCluster % clustersX - endCluster % clustersX) <= 1 &&
+        std::abs(startCluster / clustersX - endCluster / clustersX) <= 1) {
+        std::vector<Node> path = Pathfinding::findPath(grid, start, end, localState);
+        expanded = localState.getExpanded();
+        return path;
+    }
+
+    // Connect start and end to the nodes of their clusters
+    int width = grid.getWidth();
+    int startIndex = start.y * width + start.x;
+    int endIndex = end.y * width + end.x;
+    startEdges.clear();
+    searchCluster(startCluster, startIndex);
+    expanded += localState.getExpanded();
+    for (int node : clusters[startCluster].nodes) {
+        if (localState.isVisited(node)) {
+            startEdges.push_back({ node, localState.getG(node) });
+        }
+    }
+    endEdges.clear();
+    searchCluster(endCluster, endIndex);
+    expanded += localState.getExpanded();
+    for (int node : clusters[endCluster].nodes) {
+        if (localState.isVisited(node)) {
+            // Searched from the end, so the cost counts the node's cell rather than the end's
+            endEdges.push_back({ node, localState.getG(node) - grid.getStepCost(node) + grid.getStepCost(endIndex) });
+        }
+    }
+    if (startEdges.empty() || endEdges.empty()) {
+        return std::vector<Node>();
+    }
+
+    // A* over the abstract graph
+    abstractState.begin(width, grid.getHeight());
+    SearchState::OpenList& openList = abstractState.getOpenList();
+    abstractState.open(startIndex, 0, -1);
+    openList.push(startIndex, std::abs(start.x - end.x) + std::abs(start.y - end.y), 0);
+    bool found = false;
+    while (!openList.empty()) {
+        OpenEntry current = openList.pop();
+        abstractState.close(current.index);
+        if (current.index == endIndex) {
+            found = true;
+            break;
+        }
+
+        abstractEdges.clear();
+        getEdges(current.index, abstractEdges);
+        if (current.index == startIndex) {
+            abstractEdges.insert(abstractEdges.end(), startEdges.begin(), startEdges.end());
+        }
+        if (clusterOf(current.index % width, current.index / width) == endCluster) {
+            for (const std::pair<int, int>& edge : endEdges) {
+                if (edge.first == current.index) {
+                    abstractEdges.push_back({ endIndex, edge.second });
+                }
+            }
+        }
+
+        for (const std::pair<int, int>& edge : abstractEdges) {
+            int next = edge.first;
+            if (abstractState.isClosed(next)) {
+                continue;
+            }
+            int tentative_g = current.g + edge.second;
+            int f = tentative_g + std::abs(next % width - end.x) + std::abs(next / width - end.y);
+            if (!abstractState.isOpen(next)) {
+                abstractState.open(next, tentative_g, current.index);
+                openList.push(next, f, tentative_g);
+            }
+            else if (tentative_g < abstractState.getG(next)) {
+                abstractState.open(next, tentative_g, current.index);
+                openList.decreaseKey(next, f, tentative_g);
+            }
+        }
+    }
+    expanded += abstractState.getExpanded();
+    if (!found) {
+        return std::vector<Node>();
+    }
+
+    // Refine: transitions are single steps, everything else is a walk inside one cluster
+    std::vector<int> abstractPath;
+    for (int index = endIndex; index != -1; index = abstractState.getParent(index)) {
+        abstractPath.push_back(index);
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    std::vector<Node> path;
+    path.push_back(start);
+    path.back().g = 0;
+    path.back().h = 0;
+    for (size_t i = 1; i < abstractPath.size(); ++i) {
+        int from = abstractPath[i - 1];
+        int to = abstractPath[i];
+        int c = clusterOf(from % width, from / width);
+        if (c == clusterOf(to % width, to / width)) {
+            searchCluster(c, from);
+            expanded += localState.getExpanded();
+            appendLocalPath(to, path);
+        }
+        else {
+            Node node(to % width, to / width);
+            node.g = path.back().g + grid.getStepCost(to);
+            path.push_back(node);
+        }
+    }
+    return path;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include <utility>
+#include <vector>
+
+// Hierarchical pathfinding (HPA*) over a Grid.
+// The grid is cut into square clusters. Where two neighboring clusters share a run
+// of free cells along their border, one or two transitions (a pair of adjacent
+// cells, one on each side) are placed on it, and the cells of those transitions
+// become the abstract nodes of their cluster. Each cluster keeps the shortest
+// in-cluster distance between every pair of its nodes.
+// Long queries search this abstract graph and then refine each abstract edge inside
+// its cluster; the result is near-optimal. Short queries run plain A*. Distances
+// include the grid's terrain costs.
+// The hierarchy follows grid edits: a changed cell only rebuilds its own cluster,
+// plus the neighbor across a border when the cell lies on one.
+class Hierarchy : public GridObserver {
+public:
+    Hierarchy(Grid& grid, int clusterSize = 16);
+    ~Hierarchy();
+    Hierarchy(const Hierarchy&) = delete;
+    Hierarchy& operator=(const Hierarchy&) = delete;
+
+    std::vector<Node> findPath(const Node& start, const Node& end);
+    void onCellChanged(int x, int y) override;
+    // Rebuild every cluster
+    void build();
+
+    int getClusterSize() const { return clusterSize; }
+    // Abstract node count, for sizing
+    size_t getNodeCount() const;
+    // Cells and abstract nodes expanded by the last findPath, refinement included
+    size_t getExpanded() const { return expanded; }
+private:
+    // Adjacent free cells on the two sides of a cluster border
+    struct Transition {
+        int first, second; // cell indices; first is left of / above second
+    };
+
+    struct Cluster {
+        int x0, y0, x1, y1;      // cell bounds, x1/y1 exclusive
+        std::vector<int> nodes;  // cell indices of the abstract nodes
+        std::vector<int> costs;  // nodes.size() squared, -1 when there is no path inside the cluster
+    };
+
+    int clusterOf(int x, int y) const { return (y / clusterSize) * clustersX + x / clusterSize; }
+    // Border between cluster c and the one to its right / below it
+    void buildVerticalBorder(int c);
+    void buildHorizontalBorder(int c);
+    void buildCluster(int c);
+    // Dijkstra search (terrain costs included) from source that stays inside cluster c;
+    // results land in localState
+    void searchCluster(int c, int source);
+    // Walk the localState parents back from target and append the cells after the source to path
+    void appendLocalPath(int target, std::vector<Node>& path);
+    // Append the (neighbor, cost) abstract edges of a cell; nothing if it is not an abstract node
+    void getEdges(int index, std::vector<std::pair<int, int>>& edges) const;
+
+    Grid& grid;
+    int clusterSize;
+    int clustersX;
+    int clustersY;
+    std::vector<Cluster> clusters;
+    std::vector<std::vector<Transition>> verticalBorders;   // indexed by the left cluster
+    std::vector<std::vector<Transition>> horizontalBorders; // indexed by the upper cluster
+    SearchState abstractState;
+    SearchState localState;
+    std::vector<std::pair<int, int>> abstractEdges;
+    std::vector<std::pair<int, int>> startEdges;
+    std::vector<std::pair<int, int>> endEdges;
+    size_t expanded = 0;
+};
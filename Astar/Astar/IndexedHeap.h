@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Open list entry: a cell index plus the costs it was queued with
+struct OpenEntry {
+    int f, g;
+    int index;
+};
+
+// Indexed d-ary min-heap of cell indices ordered by f, ties broken towards the larger g
+// (the entry closer to the goal). Every queued cell remembers its heap position, so
+// contains() is O(1) and decreaseKey() is a single sift-up instead of a linear search.
+template <int D = 4>
+class IndexedHeap {
+public:
+    // Empty the heap and make room for cell indices in [0, cells)
+    void reset(int cells) {
+        heap.clear();
+        if (positions.size() < static_cast<size_t>(cells)) {
+            positions.resize(cells, 0);
+        }
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    const OpenEntry& top() const { return heap.front(); }
+    // Queued entries in heap order, e.g. for queueing them again under new keys
+    const std::vector<OpenEntry>& getEntries() const { return heap; }
+
+    // Positions are never cleared, so a stale slot is recognised by checking it points back at index
+    bool contains(int index) const {
+        int pos = positions[index];
+        return pos < static_cast<int>(heap.size()) && heap[pos].index == index;
+    }
+
+    void push(int index, int f, int g) {
+        heap.push_back({ f, g, index });
+        siftUp(static_cast<int>(heap.size()) - 1);
+    }
+
+    // Lower the key of a queued cell
+    void decreaseKey(int index, int f, int g) {
+        int pos = positions[index];
+        heap[pos].f = f;
+        heap[pos].g = g;
+        siftUp(pos);
+    }
+
+    // Change the key of a queued cell in either direction
+    void update(int index, int f, int g) {
+        int pos = positions[index];
+        heap[pos].f = f;
+        heap[pos].g = g;
+        siftUp(pos);
+        siftDown(positions[index]);
+    }
+
+    // Take a queued cell out of the heap
+    void remove(int index) {
+        int pos = positions[index];
+        OpenEntry last = heap.back();
+        heap.pop_back();
+        if (pos < static_cast<int>(heap.size())) {
+            place(pos, last);
+            siftUp(pos);
+            siftDown(positions[last.index]);
+        }
+    }
+
+    OpenEntry pop() {
+        OpenEntry top = heap.front();
+        OpenEntry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return top;
+    }
+private:
+    static bool before(const OpenEntry& a, const OpenEntry& b) {
+        return a.f < b.f || (a.f == b.f && a.g > b.g);
+    }
+
+    void place(int pos, const OpenEntry& entry) {
+        heap[pos] = entry;
+        positions[entry.index] = pos;
+    }
+
+    void siftUp(int pos) {
+        OpenEntry entry = heap[pos];
+        while (pos > 0) {
+            int parent = (pos - 1) / D;
+            if (!before(entry, heap[parent])) {
+                break;
+            }
+            place(pos, heap[parent]);
+            pos = parent;
+        }
+        place(pos, entry);
+    }
+
+    void siftDown(int pos) {
+        OpenEntry entry = heap[pos];
+        int count = static_cast<int>(heap.size());
+        while (true) {
+            int first = pos * D + 1;
+            if (first >= count) {
+                break;
+            }
+            int last = first + D < count ? first + D : count;
+            int best = first;
+            for (int child = first + 1; child < last; ++child) {
+                if (before(heap[child], heap[best])) {
+                    best = child;
+                }
+            }
+            if (!before(heap[best], entry)) {
+                break;
+            }
+            place(pos, heap[best]);
+            pos = best;
+        }
+        place(pos, entry);
+    }
+
+    std::vector<OpenEntry> heap;
+    std::vector<int> positions;
+};
@@ -0,0 +1,205 @@
+#include "JumpPointSearch.h"
+#include "Bits.h"
+#include <algorithm>
+#include <cstdlib>
+
+std::vector<Node> JumpPointSearch::findPath(const Grid& grid, const Node& start, const Node& end, SearchState& state, const JumpTable* table) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    state.begin(width, height);
+    if (!grid.isReachable(start.x, start.y, end.x, end.y)) {
+        state.finish(); // still counted in the stats, with no expansions
+        return std::vector<Node>();
+    }
+    if (table && (table->getWidth() != width || table->getHeight() != height)) {
+        table = nullptr; // built for another grid, scan instead
+    }
+    SearchState::OpenList& openList = state.getOpenList();
+
+    int startIndex = start.y * width + start.x;
+    int endIndex = end.y * width + end.x;
+    state.open(startIndex, 0, -1);
+    openList.push(startIndex, std::abs(start.x - end.x) + std::abs(start.y - end.y), 0);
+    state.recordPush(openList.size());
+    state.startPhase(SearchStats::SEARCH);
+
+    while (!openList.empty()) {
+        OpenEntry current = openList.pop();
+        state.close(current.index);
+        state.traceExpand(current.index, current.f);
+
+        if (current.index == endIndex) {
+            state.startPhase(SearchStats::PATH);
+            std::vector<Node> path = buildPath(state, endIndex);
+            state.finish();
+            return path;
+        }
+        if (state.shouldStop()) {
+            break;
+        }
+
+        int x = current.index % width;
+        int y = current.index / width;
+        unsigned directions = successors(grid, x, y, state.getParent(current.index));
+        for (unsigned direction = Grid::RIGHT; direction <= Grid::UP; direction <<= 1) {
+            if (!(directions & direction)) {
+                continue;
+            }
+            int next = table ? jumpTable(*table, x, y, direction, end) : jump(grid, x, y, direction, end);
+            if (next < 0 || state.isClosed(next)) {
+                continue;
+            }
+
+            int nx = next % width;
+            int ny = next / width;
+            int tentative_g = current.g + std::abs(nx - x) + std::abs(ny - y);
+            int f = tentative_g + std::abs(nx - end.x) + std::abs(ny - end.y);
+            if (!state.isOpen(next)) {
+                state.open(next, tentative_g, current.index);
+                state.traceNeighbor(next, tentative_g, f);
+                openList.push(next, f, tentative_g);
+                state.recordPush(openList.size());
+            }
+            else if (tentative_g < state.getG(next)) {
+                state.open(next, tentative_g, current.index);
+                state.traceNeighbor(next, tentative_g, f);
+                openList.decreaseKey(next, f, tentative_g);
+                state.recordDecreaseKey();
+            }
+        }
+    }
+
+    state.finish();
+    return std::vector<Node>();
+}
+
+int JumpPointSearch::jump(const Grid& grid, int x, int y, unsigned direction, const Node& end) {
+    int width = grid.getWidth();
+    if (direction == Grid::RIGHT || direction == Grid::LEFT) {
+        int nx = jumpHorizontal(grid, x, y, direction == Grid::RIGHT ? 1 : -1, end);
+        return nx < 0 ? -1 : y * width + nx;
+    }
+    int ny = jumpVertical(grid, x, y, direction == Grid::DOWN ? 1 : -1, end);
+    return ny < 0 ? -1 : ny * width + x;
+}
+
+int JumpPointSearch::jumpTable(const JumpTable& table, int x, int y, unsigned direction, const Node& end) {
+    int width = table.getWidth();
+    int index = y * width + x;
+    if (direction == Grid::RIGHT || direction == Grid::LEFT) {
+        int dx = direction == Grid::RIGHT ? 1 : -1;
+        int distance = table.getDistance(index, dx > 0 ? JumpTable::RIGHT : JumpTable::LEFT);
+        // The goal lies on this row before the jump point or wall
+        int steps = (end.x - x) * dx;
+        if (end.y == y && steps > 0 && steps <= std::abs(distance)) {
+            return y * width + end.x;
+        }
+        return distance > 0 ? index + dx * distance : -1;
+    }
+
+    int dy = direction == Grid::DOWN ? 1 : -1;
+    int distance = table.getDistance(index, dy > 0 ? JumpTable::DOWN : JumpTable::UP);
+    // Stop on the goal's row so the horizontal jumps from there can reach it
+    int steps = (end.y - y) * dy;
+    if (steps > 0 && steps <= std::abs(distance)) {
+        return end.y * width + x;
+    }
+    return distance > 0 ? index + dy * distance * width : -1;
+}
+
+int JumpPointSearch::jumpHorizontal(const Grid& grid, int x, int y, int dx, const Node& end) {
+    bool goalRow = end.y == y;
+    if (dx > 0) {
+        // 64 cells at a time, bit k describes cell from + k
+        for (int from = x + 1; ; from += 64) {
+            std::uint64_t blocked = grid.rowBits(from, y);
+            std::uint64_t forced = (~grid.rowBits(from, y - 1) & grid.rowBits(from - 1, y - 1))
+                | (~grid.rowBits(from, y + 1) & grid.rowBits(from - 1, y + 1));
+            std::uint64_t stop = blocked | forced;
+            if (goalRow && end.x >= from && end.x < from + 64) {
+                stop |= 1ULL << (end.x - from);
+            }
+            if (stop != 0) {
+                int k = countTrailingZeros(stop);
+                return (blocked >> k) & 1 ? -1 : from + k;
+            }
+        }
+    }
+
+    // Moving left the nearest cell is the highest bit: bit k describes cell from + k
+    for (int to = x - 1; ; to -= 64) {
+        int from = to - 63;
+        std::uint64_t blocked = grid.rowBits(from, y);
+        std::uint64_t forced = (~grid.rowBits(from, y - 1) & grid.rowBits(from + 1, y - 1))
+            | (~grid.rowBits(from, y + 1) & grid.rowBits(from + 1, y + 1));
+        std::uint64_t stop = blocked | forced;
+        if (goalRow && end.x >= from && end.x <= to) {
+            stop |= 1ULL << (end.x - from);
+        }
+        if (stop != 0) {
+            int k = 63 - countLeadingZeros(stop);
+            return (blocked >> k) & 1 ? -1 : from + k;
+        }
+    }
+}
+
+int JumpPointSearch::jumpVertical(const Grid& grid, int x, int y, int dy, const Node& end) {
+    for (int ny = y + dy; ; ny += dy) {
+        if (!grid.isPassable(x, ny)) {
+            return -1;
+        }
+        if (x == end.x && ny == end.y) {
+            return ny;
+        }
+        if (jumpHorizontal(grid, x, ny, 1, end) >= 0 || jumpHorizontal(grid, x, ny, -1, end) >= 0) {
+            return ny;
+        }
+    }
+}
+
+unsigned JumpPointSearch::successors(const Grid& grid, int x, int y, int parentIndex) {
+    if (parentIndex < 0) {
+        return Grid::RIGHT | Grid::DOWN | Grid::LEFT | Grid::UP;
+    }
+    int px = parentIndex % grid.getWidth();
+    int py = parentIndex / grid.getWidth();
+    if (px == x) {
+        return (y > py ? Grid::DOWN : Grid::UP) | Grid::LEFT | Grid::RIGHT;
+    }
+
+    // Horizontal moves only turn where an obstacle behind forces it
+    int dx = x > px ? 1 : -1;
+    unsigned directions = dx > 0 ? Grid::RIGHT : Grid::LEFT;
+    if (grid.isPassable(x, y - 1) && !grid.isPassable(x - dx, y - 1)) {
+        directions |= Grid::UP;
+    }
+    if (grid.isPassable(x, y + 1) && !grid.isPassable(x - dx, y + 1)) {
+        directions |= Grid::DOWN;
+    }
+    return directions;
+}
+
+std::vector<Node> JumpPointSearch::buildPath(const SearchState& state, int endIndex) {
+    int width = state.getWidth();
+    std::vector<int> jumpPoints;
+    for (int index = endIndex; index != -1; index = state.getParent(index)) {
+        jumpPoints.push_back(index);
+    }
+    std::reverse(jumpPoints.begin(), jumpPoints.end());
+
+    // Fill in the straight runs between jump points
+    std::vector<Node> path;
+    Node node(jumpPoints[0] % width, jumpPoints[0] / width);
+    path.push_back(node);
+    for (size_t i = 1; i < jumpPoints.size(); ++i) {
+        int tx = jumpPoints[i] % width;
+        int ty = jumpPoints[i] / width;
+        while (node.x != tx || node.y != ty) {
+            node.x += (tx > node.x) - (tx < node.x);
+            node.y += (ty > node.y) - (ty < node.y);
+            node.g += 1;
+            path.push_back(node);
+        }
+    }
+    return path;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Grid.h"
+#include "JumpTable.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include <vector>
+
+// Jump Point Search for 4-connected, uniform-cost grids.
+// Symmetric routes are pruned with a canonical ordering that takes vertical moves
+// before horizontal ones. Moving vertically, the search keeps going until a
+// horizontal jump from the current cell finds something. Moving horizontally, it
+// stops only at the goal or at a forced neighbor: a free cell above or below whose
+// own neighbor behind is blocked. Path costs are the same as plain 4-connected A*.
+class JumpPointSearch {
+public:
+    // Jumps are found by scanning the grid a word at a time, or read from table (JPS+) when one is given
+    static std::vector<Node> findPath(const Grid& grid, const Node& start, const Node& end, SearchState& state, const JumpTable* table);
+private:
+    // Index of the jump point reached from (x, y) in the given Grid direction bit, or -1
+    static int jump(const Grid& grid, int x, int y, unsigned direction, const Node& end);
+    static int jumpTable(const JumpTable& table, int x, int y, unsigned direction, const Node& end);
+    // Column of the first jump point in row y after x moving in dx, or -1
+    static int jumpHorizontal(const Grid& grid, int x, int y, int dx, const Node& end);
+    // Row of the first jump point in column x after y moving in dy, or -1
+    static int jumpVertical(const Grid& grid, int x, int y, int dy, const Node& end);
+    // Grid direction bits worth jumping in from a cell, given the cell it was reached from
+    static unsigned successors(const Grid& grid, int x, int y, int parentIndex);
+    static std::vector<Node> buildPath(const SearchState& state, int endIndex);
+};
@@ -0,0 +1,82 @@
+#include "JumpTable.h"
+
+namespace {
+    // Distance from a cell given the entry of the next cell in the same direction
+    int extend(int next) {
+        return next > 0 ? next + 1 : next - 1;
+    }
+}
+
+void JumpTable::build(const Grid& grid) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    version = grid.getVersion();
+    distances.assign(static_cast<size_t>(width) * height * 4, 0);
+
+    // Horizontal distances. A cell reached moving in direction dx is a jump point when a
+    // vertical neighbor is free but the cell behind that neighbor is blocked (forced neighbor).
+    for (int y = 0; y < height; ++y) {
+        for (int x = width - 2; x >= 0; --x) {
+            int index = y * width + x;
+            int nx = x + 1;
+            if (!grid.isPassable(nx, y)) {
+                distances[index * 4 + RIGHT] = 0;
+            }
+            else if ((grid.isPassable(nx, y - 1) && !grid.isPassable(x, y - 1)) ||
+                     (grid.isPassable(nx, y + 1) && !grid.isPassable(x, y + 1))) {
+                distances[index * 4 + RIGHT] = 1;
+            }
+            else {
+                distances[index * 4 + RIGHT] = extend(distances[(index + 1) * 4 + RIGHT]);
+            }
+        }
+        for (int x = 1; x < width; ++x) {
+            int index = y * width + x;
+            int nx = x - 1;
+            if (!grid.isPassable(nx, y)) {
+                distances[index * 4 + LEFT] = 0;
+            }
+            else if ((grid.isPassable(nx, y - 1) && !grid.isPassable(x, y - 1)) ||
+                     (grid.isPassable(nx, y + 1) && !grid.isPassable(x, y + 1))) {
+                distances[index * 4 + LEFT] = 1;
+            }
+            else {
+                distances[index * 4 + LEFT] = extend(distances[(index - 1) * 4 + LEFT]);
+            }
+        }
+    }
+
+    // Vertical distances. Moving vertically every horizontal direction is natural, so a
+    // cell is a jump point when a horizontal jump from it finds one.
+    auto horizontalJump = [&](int index) {
+        return distances[index * 4 + RIGHT] > 0 || distances[index * 4 + LEFT] > 0;
+    };
+    for (int x = 0; x < width; ++x) {
+        for (int y = height - 2; y >= 0; --y) {
+            int index = y * width + x;
+            int next = index + width;
+            if (!grid.isPassable(x, y + 1)) {
+                distances[index * 4 + DOWN] = 0;
+            }
+            else if (horizontalJump(next)) {
+                distances[index * 4 + DOWN] = 1;
+            }
+            else {
+                distances[index * 4 + DOWN] = extend(distances[next * 4 + DOWN]);
+            }
+        }
+        for (int y = 1; y < height; ++y) {
+            int index = y * width + x;
+            int next = index - width;
+            if (!grid.isPassable(x, y - 1)) {
+                distances[index * 4 + UP] = 0;
+            }
+            else if (horizontalJump(next)) {
+                distances[index * 4 + UP] = 1;
+            }
+            else {
+                distances[index * 4 + UP] = extend(distances[next * 4 + UP]);
+            }
+        }
+    }
+}
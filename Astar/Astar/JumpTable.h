@@ -0,0 +1,37 @@
+#pragma once
+#include "Grid.h"
+#include <cstdint>
+#include <vector>
+
+// Precomputed jump distances for JPS+ on a 4-connected grid.
+// For every cell and direction the table holds the number of steps to the next
+// jump point (positive) or, when the scan runs into a wall first, minus the
+// number of free steps before the wall (zero or negative). The goal is not
+// part of the table; the search handles it when it reads a distance.
+// The table describes the grid as it was at the last build(), so rebuild it after edits;
+// matches() tells whether it still does (Pathfinding::findPath falls back to plain JPS
+// when it does not).
+class JumpTable {
+public:
+    // Directions, in the same order as the Grid neighbor bits
+    enum Direction { RIGHT = 0, DOWN = 1, LEFT = 2, UP = 3 };
+
+    JumpTable() : width(0), height(0), version(0) {}
+    explicit JumpTable(const Grid& grid) { build(grid); }
+
+    void build(const Grid& grid);
+    int getDistance(int index, int direction) const { return distances[static_cast<size_t>(index) * 4 + direction]; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Built from grid at its current version. A copy of the grid starts its own version
+    // count, so the table only matches the grid object it was built from (or one that
+    // happens to be at the same version).
+    bool matches(const Grid& grid) const {
+        return width == grid.getWidth() && height == grid.getHeight() && version == grid.getVersion() && !distances.empty();
+    }
+private:
+    int width;
+    int height;
+    std::uint64_t version; // of the grid at build()
+    std::vector<std::int32_t> distances;
+};
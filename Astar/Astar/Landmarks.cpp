@@ -0,0 +1,348 @@
+#include "Landmarks.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const int INF = INT_MAX / 2;
+    const char MAGIC[4] = { 'A', 'L', 'T', 'L' };
+    const std::uint32_t FORMAT_VERSION = 1;
+
+    // Start of a table file, little-endian; the landmark cells and the table follow
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t count;
+        std::uint32_t scale;
+        std::uint64_t checksum;
+    };
+
+    // Exact distances from source, each step costing what the entered cell costs; INF where unreachable
+    void dijkstra(const Grid& grid, int source, std::vector<int>& dist, BucketQueue<512>& queue) {
+        int cells = grid.getWidth() * grid.getHeight();
+        dist.assign(cells, INF);
+        queue.reset(cells);
+        dist[source] = 0;
+        queue.push(source, 0, 0);
+        while (!queue.empty()) {
+            OpenEntry current = queue.pop();
+            int neighbors[8];
+            int costs[8];
+            int n = WeightedFourConnected::expand(grid, current.index, neighbors, costs);
+            for (int i = 0; i < n; ++i) {
+                int neighbor = neighbors[i];
+                int d = current.g + costs[i];
+                if (d < dist[neighbor]) {
+                    bool queued = dist[neighbor] < INF; // and not yet popped, as popped cells are final
+                    dist[neighbor] = d;
+                    if (queued) {
+                        queue.decreaseKey(neighbor, d, d);
+                    }
+                    else {
+                        queue.push(neighbor, d, d);
+                    }
+                }
+            }
+        }
+    }
+
+    void hash(std::uint64_t& h, std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            h = (h ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ULL; // FNV-1a
+        }
+    }
+}
+
+Landmarks::Landmarks(Grid& grid)
+    : grid(grid), width(grid.getWidth()), height(grid.getHeight()), count(0), scale(1), valid(false) {
+    grid.addObserver(this);
+}
+
+Landmarks::~Landmarks() {
+    grid.removeObserver(this);
+}
+
+bool Landmarks::build(int count, unsigned threads) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    int cells = width * height;
+    if (count > MAX_LANDMARKS) {
+        count = MAX_LANDMARKS;
+    }
+    if (count < 1) {
+        count = 1;
+    }
+    valid = false;
+    this->count = 0;
+    table.clear();
+
+    // Start from a cell of the largest region (any free cell without component labels)
+    int seed = -1;
+    for (int index = 0; index < cells; ++index) {
+        if (!grid.isPassable(index % width, index / width)) {
+            continue;
+        }
+        if (!grid.hasComponents()) {
+            seed = index;
+            break;
+        }
+        const ComponentIndex& components = grid.getComponents();
+        if (seed < 0 || components.getSize(components.get(index)) > components.getSize(components.get(seed))) {
+            seed = index;
+        }
+    }
+    if (seed < 0) {
+        return false;
+    }
+
+    // The first landmark is the cell farthest from the seed. Every distance in the region is
+    // at most twice the seed's, plus a cell cost for the direction, which sets the scale.
+    ThreadPool pool(std::max(1u, threads));
+    std::vector<std::vector<int>> dist(pool.size());
+    dijkstra(grid, seed, dist[0], queue);
+    int farthest = seed;
+    for (int index = 0; index < cells; ++index) {
+        if (dist[0][index] < INF && dist[0][index] > dist[0][farthest]) {
+            farthest = index;
+        }
+    }
+    scale = (2 * dist[0][farthest] + Grid::MAX_COST) / (UNREACHED - 1) + 1;
+    landmarks[0] = farthest;
+    this->count = count;
+    table.assign(static_cast<size_t>(cells) * count, static_cast<std::uint16_t>(UNREACHED));
+    computeTables(0, 1, pool, dist);
+    std::vector<int> nearest = dist[0]; // distance to the closest landmark so far
+
+    // Each round picks one landmark per worker: the free cell farthest from the landmarks
+    // so far, then the next farthest that is also far from the cells picked this round.
+    // Manhattan distance stands in for the distance to those, as their searches have not run.
+    int chosen = 1;
+    while (chosen < count) {
+        int batch = std::min(static_cast<int>(pool.size()), count - chosen);
+        int picked = 0;
+        for (; picked < batch; ++picked) {
+            int best = -1;
+            int bestKey = 0;
+            for (int index = 0; index < cells; ++index) {
+                int key = nearest[index];
+                if (key >= INF) {
+                    continue;
+                }
+                for (int p = chosen; p < chosen + picked && key > bestKey; ++p) {
+                    int manhattan = std::abs(index % width - landmarks[p] % width) + std::abs(index / width - landmarks[p] / width);
+                    key = std::min(key, manhattan);
+                }
+                if (key > bestKey) {
+                    best = index;
+                    bestKey = key;
+                }
+            }
+            if (best < 0) {
+                break; // every reachable cell is a landmark
+            }
+            landmarks[chosen + picked] = best;
+        }
+        if (picked == 0) {
+            break;
+        }
+        computeTables(chosen, picked, pool, dist);
+        for (int p = 0; p < picked; ++p) {
+            for (int index = 0; index < cells; ++index) {
+                nearest[index] = std::min(nearest[index], dist[p][index]);
+            }
+        }
+        chosen += picked;
+    }
+
+    if (chosen < count) {
+        // Fewer cells than landmarks asked for; drop the unused columns
+        std::vector<std::uint16_t> packed(static_cast<size_t>(cells) * chosen);
+        for (int index = 0; index < cells; ++index) {
+            std::copy_n(&table[static_cast<size_t>(index) * count], chosen, &packed[static_cast<size_t>(index) * chosen]);
+        }
+        table.swap(packed);
+        this->count = chosen;
+    }
+    valid = true;
+    return true;
+}
+
+void Landmarks::computeTables(int first, int n, ThreadPool& pool, std::vector<std::vector<int>>& dist) {
+    int cells = width * height;
+    auto fill = [&](int i, BucketQueue<512>& open) {
+        int column = first + i;
+        std::vector<int>& d = dist[i];
+        dijkstra(grid, landmarks[column], d, open);
+        for (int index = 0; index < cells; ++index) {
+            int stored = d[index] >= INF ? UNREACHED : d[index] / scale;
+            table[static_cast<size_t>(index) * count + column] = static_cast<std::uint16_t>(stored < UNREACHED ? stored : UNREACHED);
+        }
+    };
+    if (n == 1 || pool.size() == 1) {
+        // Nothing to share out (the first landmark, or a single worker); stay on this thread
+        for (int i = 0; i < n; ++i) {
+            fill(i, queue);
+        }
+        return;
+    }
+    std::vector<BucketQueue<512>> queues(pool.size());
+    pool.parallelFor(n, [&](size_t i, unsigned worker) {
+        fill(static_cast<int>(i), queues[worker]);
+    });
+}
+
+Landmarks::Heuristic Landmarks::heuristicFor(const Node& goal) const {
+    Heuristic heuristic;
+    heuristic.landmarks = this;
+    heuristic.goalCost = 1;
+    std::fill(heuristic.goal, heuristic.goal + MAX_LANDMARKS, -1);
+    if (valid && goal.x >= 0 && goal.x < width && goal.y >= 0 && goal.y < height) {
+        int index = goal.y * width + goal.x;
+        heuristic.goalCost = grid.getStepCost(index);
+        for (int i = 0; i < count; ++i) {
+            std::uint16_t stored = table[static_cast<size_t>(index) * count + i];
+            heuristic.goal[i] = stored == UNREACHED ? -1 : stored;
+        }
+    }
+    return heuristic;
+}
+
+std::vector<Node> Landmarks::findPath(const Node& start, const Node& end, SearchState& state) const {
+    return Pathfinding::findPathWith<WeightedFourConnected>(grid, start, end, state, heuristicFor(end));
+}
+
+void Landmarks::onCellChanged(int x, int y) {
+    if (!valid || !grid.isPassable(x, y)) {
+        return; // blocking a cell only leaves the stored distances as lower bounds
+    }
+    if (scale > 1) {
+        valid = false; // repairs need exact distances
+        return;
+    }
+    repair(y * width + x);
+}
+
+void Landmarks::repair(int index) {
+    int cells = width * height;
+    int neighbors[8];
+    int costs[8];
+    for (int i = 0; i < count; ++i) {
+        auto distance = [&](int cell) {
+            std::uint16_t stored = table[static_cast<size_t>(cell) * count + i];
+            return stored == UNREACHED ? INF : static_cast<int>(stored);
+        };
+
+        // The cell's own distance may drop through any free neighbor, and then spread from it
+        int best = landmarks[i] == index ? 0 : distance(index);
+        int n = WeightedFourConnected::expand(grid, index, neighbors, costs);
+        for (int k = 0; k < n; ++k) {
+            best = std::min(best, distance(neighbors[k]) + grid.getStepCost(index));
+        }
+        if (best >= INF) {
+            continue;
+        }
+        table[static_cast<size_t>(index) * count + i] = static_cast<std::uint16_t>(best);
+        queue.reset(cells);
+        queue.push(index, best, best);
+        while (!queue.empty()) {
+            OpenEntry current = queue.pop();
+            n = WeightedFourConnected::expand(grid, current.index, neighbors, costs);
+            for (int k = 0; k < n; ++k) {
+                int neighbor = neighbors[k];
+                int d = current.g + costs[k];
+                if (d >= distance(neighbor)) {
+                    continue;
+                }
+                if (d >= UNREACHED) {
+                    valid = false; // joined a region too far away for the table
+                    return;
+                }
+                table[static_cast<size_t>(neighbor) * count + i] = static_cast<std::uint16_t>(d);
+                if (queue.contains(neighbor)) {
+                    queue.decreaseKey(neighbor, d, d);
+                }
+                else {
+                    queue.push(neighbor, d, d);
+                }
+            }
+        }
+    }
+}
+
+std::uint64_t Landmarks::checksum() const {
+    std::uint64_t h = 14695981039346656037ULL;
+    hash(h, static_cast<std::uint64_t>(width) << 32 | static_cast<std::uint32_t>(height));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; x += 64) {
+            hash(h, grid.rowBits(x, y));
+        }
+    }
+    if (grid.hasCosts()) {
+        for (int index = 0; index < width * height; ++index) {
+            int cost = grid.getStepCost(index);
+            if (cost != 1) {
+                hash(h, static_cast<std::uint64_t>(index) << 8 | static_cast<std::uint64_t>(cost));
+            }
+        }
+    }
+    return h;
+}
+
+bool Landmarks::save(const std::string& path) const {
+    if (!valid) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    Header header = { { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] }, FORMAT_VERSION, static_cast<std::uint32_t>(width),
+                      static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(count), static_cast<std::uint32_t>(scale), checksum() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(landmarks), sizeof(int) * count);
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(std::uint16_t));
+    return static_cast<bool>(file);
+}
+
+bool Landmarks::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    Header header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.width != static_cast<std::uint32_t>(grid.getWidth()) || header.height != static_cast<std::uint32_t>(grid.getHeight()) ||
+        header.count < 1 || header.count > MAX_LANDMARKS || header.scale < 1) {
+        return false;
+    }
+    int savedWidth = width;
+    int savedHeight = height;
+    width = grid.getWidth();
+    height = grid.getHeight();
+    bool matches = header.checksum == checksum();
+    width = savedWidth;
+    height = savedHeight;
+    if (!matches) {
+        return false;
+    }
+
+    int loadedLandmarks[MAX_LANDMARKS];
+    std::vector<std::uint16_t> loaded(static_cast<size_t>(grid.getWidth()) * grid.getHeight() * header.count);
+    if (!file.read(reinterpret_cast<char*>(loadedLandmarks), sizeof(int) * header.count) ||
+        !file.read(reinterpret_cast<char*>(loaded.data()), loaded.size() * sizeof(std::uint16_t))) {
+        return false;
+    }
+    width = grid.getWidth();
+    height = grid.getHeight();
+    count = static_cast<int>(header.count);
+    scale = static_cast<int>(header.scale);
+    std::copy_n(loadedLandmarks, count, landmarks);
+    table.swap(loaded);
+    valid = true;
+    return true;
+}
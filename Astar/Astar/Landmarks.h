@@ -0,0 +1,109 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinding.h"
+#include "SearchPolicies.h"
+#include "SearchState.h"
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+// ALT heuristic: exact 4-connected distances (with terrain costs) from a few landmark
+// cells to every cell. For any landmark L the triangle inequality gives
+//   d(v, t) >= d(L, t) - d(L, v)   and   d(v, t) >= d(v, L) - d(t, L),
+// and as a step costs what the cell it enters costs, d(v, L) = d(L, v) + cost(L) - cost(v),
+// so one table per landmark serves both bounds. The heuristic is the largest of these
+// bounds and Manhattan distance, which on maze-like maps is far closer to the real cost.
+// Landmarks are picked by farthest-point selection, in rounds of one per worker thread
+// whose Dijkstra searches run in parallel. Distances are stored as 16-bit values, scaled
+// down when the map is too large for them; the bounds allow for the rounding.
+// Edits arrive through the Grid observer hook. A cell that gets blocked or dearer only
+// makes the stored distances lower bounds, which keeps the heuristic admissible. A cell
+// that gets freed or cheaper is repaired by pushing the shorter distances outwards from
+// it; with scaled tables it instead disables the landmarks until the next build().
+class Landmarks : public GridObserver {
+public:
+    static const int MAX_LANDMARKS = 16;
+
+    // Heuristic towards one goal, for Pathfinding::findPathWith with a 4-connected policy
+    class Heuristic {
+    public:
+        template <typename Neighbors>
+        int estimate(int index, int dx, int dy) const;
+    private:
+        friend class Landmarks;
+        const Landmarks* landmarks;
+        int goalCost;
+        int goal[MAX_LANDMARKS]; // scaled distance from each landmark to the goal, -1 if unknown
+    };
+
+    explicit Landmarks(Grid& grid);
+    ~Landmarks();
+    Landmarks(const Landmarks&) = delete;
+    Landmarks& operator=(const Landmarks&) = delete;
+
+    // Pick count landmarks (at most MAX_LANDMARKS) in the largest region and fill their
+    // tables; false when the grid has no free cell
+    bool build(int count, unsigned threads = std::thread::hardware_concurrency());
+    // Tables for this grid, written by save(); false (leaving the landmarks as they were)
+    // when the file cannot be read or was made for different cells or costs
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    // False before build()/load() and after an edit the tables could not follow
+    bool isValid() const { return valid; }
+
+    Heuristic heuristicFor(const Node& goal) const;
+    // A* with the landmark heuristic; without valid tables it is plain Manhattan A*
+    std::vector<Node> findPath(const Node& start, const Node& end, SearchState& state) const;
+
+    int getCount() const { return count; }
+    Node getLandmark(int i) const { return Node(landmarks[i] % width, landmarks[i] / width); }
+    // Distances are stored divided by this
+    int getScale() const { return scale; }
+    void onCellChanged(int x, int y) override;
+private:
+    static const std::uint16_t UNREACHED = 0xFFFF;
+
+    // Fill the tables of landmarks [first, first + n), one per pool worker when there are
+    // several; dist[i] gets the exact distances from landmark first + i
+    void computeTables(int first, int n, ThreadPool& pool, std::vector<std::vector<int>>& dist);
+    // Lower the distances around a cell that was freed or got cheaper (unscaled tables only)
+    void repair(int index);
+    std::uint64_t checksum() const;
+
+    Grid& grid;
+    int width;
+    int height;
+    int count;
+    int scale;
+    bool valid;
+    int landmarks[MAX_LANDMARKS];    // cell indices
+    std::vector<std::uint16_t> table; // count entries per cell, cell-major
+    BucketQueue<512> queue;           // for repairs and single-landmark rounds
+};
+
+template <typename Neighbors>
+int Landmarks::Heuristic::estimate(int index, int dx, int dy) const {
+    static_assert(Neighbors::STRAIGHT_COST == 1 && Neighbors::DIAGONAL_COST == 2,
+                  "landmark distances are in 4-connected step costs");
+    int h = dx + dy;
+    const Landmarks& alt = *landmarks;
+    if (!alt.valid) {
+        return h;
+    }
+    // Stored values are rounded down, so each difference may be off by scale - 1
+    int slack = alt.scale - 1;
+    int costDifference = goalCost - alt.grid.getStepCost(index);
+    const std::uint16_t* distances = &alt.table[static_cast<size_t>(index) * alt.count];
+    for (int i = 0; i < alt.count; ++i) {
+        if (goal[i] < 0 || distances[i] == UNREACHED) {
+            continue;
+        }
+        int difference = (goal[i] - distances[i]) * alt.scale;
+        int bound = std::max(difference, -difference + costDifference) - slack;
+        h = std::max(h, bound);
+    }
+    return h;
+}
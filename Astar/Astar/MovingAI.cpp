@@ -0,0 +1,73 @@
+#include "MovingAI.h"
+#include <fstream>
+#include <sstream>
+
+bool MovingAI::loadMap(const std::string& path, Grid& grid) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    if (!readMapHeader(file, width, height)) {
+        return false;
+    }
+
+    Grid loaded(width, height);
+    std::string line;
+    for (int y = 0; y < height; ++y) {
+        if (!std::getline(file, line) || static_cast<int>(line.size()) < width) {
+            return false;
+        }
+        for (int x = 0; x < width; ++x) {
+            if (!isPassableTerrain(line[x])) {
+                loaded.setObstacle(x, y);
+            }
+        }
+    }
+    loaded.buildComponents();
+    grid = loaded;
+    return true;
+}
+
+bool MovingAI::readMapHeader(std::istream& file, int& width, int& height) {
+    // "type octile", "height H", "width W", "map" in this order
+    std::string word, type;
+    if (!(file >> word >> type) || word != "type") return false;
+    if (!(file >> word >> height) || word != "height") return false;
+    if (!(file >> word >> width) || word != "width") return false;
+    if (!(file >> word) || word != "map") return false;
+    if (width <= 0 || height <= 0) return false;
+    std::string rest;
+    std::getline(file, rest); // rest of the "map" line
+    return true;
+}
+
+bool MovingAI::loadScenarios(const std::string& path, std::vector<Scenario>& scenarios) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line.compare(0, 7, "version") != 0) {
+        return false;
+    }
+
+    std::vector<Scenario> loaded;
+    while (std::getline(file, line)) {
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+        std::istringstream fields(line);
+        Scenario scenario;
+        if (!(fields >> scenario.bucket >> scenario.map >> scenario.mapWidth >> scenario.mapHeight
+                     >> scenario.startX >> scenario.startY >> scenario.goalX >> scenario.goalY >> scenario.optimalLength)) {
+            return false;
+        }
+        loaded.push_back(scenario);
+    }
+    scenarios.swap(loaded);
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Grid.h"
+#include <istream>
+#include <string>
+#include <vector>
+
+// One query from a Moving AI benchmark scenario (.scen) file
+struct Scenario {
+    int bucket;
+    std::string map;
+    int mapWidth, mapHeight;
+    int startX, startY;
+    int goalX, goalY;
+    double optimalLength; // octile distance: straight steps cost 1, diagonal steps sqrt(2)
+};
+
+// Loaders for the Moving AI Lab grid benchmark formats (movingai.com/benchmarks).
+// The loaders return false, leaving their output untouched, when the file cannot be read or parsed.
+class MovingAI {
+public:
+    // '.', 'G' and 'S' are passable; '@', 'O', 'T' and 'W' are obstacles. The grid comes back
+    // with its component labels built.
+    static bool loadMap(const std::string& path, Grid& grid);
+    static bool loadScenarios(const std::string& path, std::vector<Scenario>& scenarios);
+
+    // Read the .map header up to and including the "map" line, leaving file at the first row
+    static bool readMapHeader(std::istream& file, int& width, int& height);
+    static bool isPassableTerrain(char c) { return c == '.' || c == 'G' || c == 'S'; }
+};
@@ -0,0 +1,114 @@
+#include "PathCache.h"
+#include <cstdlib>
+#include <iterator>
+
+PathCache::PathCache(Grid& grid, size_t capacity, SearchMode mode)
+    : grid(grid), capacity(capacity > 0 ? capacity : 1), mode(mode) {
+    resetStats();
+    grid.addObserver(this);
+}
+
+PathCache::~PathCache() {
+    grid.removeObserver(this);
+}
+
+std::vector<Node> PathCache::findPath(const Node& start, const Node& end) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= height ||
+        end.x < 0 || end.y < 0 || end.x >= width || end.y >= height) {
+        // No path, and no key: (width, 0) would share one with (0, 1)
+        return std::vector<Node>();
+    }
+    std::uint64_t cells = static_cast<std::uint64_t>(grid.getWidth()) * grid.getHeight();
+    std::uint64_t key = (static_cast<std::uint64_t>(start.y) * grid.getWidth() + start.x) * cells
+        + static_cast<std::uint64_t>(end.y) * grid.getWidth() + end.x;
+
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+        EntryList::iterator it = found->second;
+        if (it->version == grid.getVersion()) {
+            ++stats.hits;
+            entries.splice(entries.begin(), entries, it);
+            return it->path;
+        }
+        ++stats.invalidations;
+        erase(it);
+    }
+    ++stats.misses;
+
+    Entry entry;
+    entry.key = key;
+    entry.startX = start.x;
+    entry.startY = start.y;
+    entry.goalX = end.x;
+    entry.goalY = end.y;
+    entry.path = Pathfinding::findPath(grid, start, end, state, mode);
+    entry.length = entry.path.empty() ? -1 : entry.path.back().g;
+    entry.version = grid.getVersion();
+
+    if (entries.size() >= capacity) {
+        ++stats.evictions;
+        erase(std::prev(entries.end()));
+    }
+    entries.push_front(entry);
+    lookup[key] = entries.begin();
+    return entries.front().path;
+}
+
+void PathCache::onCellChanged(int x, int y) {
+    bool blocked = grid.isObstacle(x, y);
+    std::uint64_t version = grid.getVersion();
+    for (EntryList::iterator it = entries.begin(); it != entries.end();) {
+        EntryList::iterator next = std::next(it);
+        if (affectedBy(*it, x, y, blocked)) {
+            ++stats.invalidations;
+            erase(it);
+        }
+        else if (it->version == version - 1) {
+            // Valid before this edit and untouched by it
+            it->version = version;
+        }
+        it = next;
+    }
+}
+
+bool PathCache::affectedBy(const Entry& entry, int x, int y, bool blocked) {
+    if (entry.length < 0) {
+        // Removing a cell cannot connect anything; freeing one might
+        return !blocked;
+    }
+    // Shortest possible route from start to goal through (x, y)
+    int via = std::abs(x - entry.startX) + std::abs(y - entry.startY)
+        + std::abs(x - entry.goalX) + std::abs(y - entry.goalY);
+    if (!blocked && via < entry.length) {
+        return true;
+    }
+    // Blocked, or a free cell whose cost changed: only a path through it is affected
+    if (via > entry.length) {
+        return false;
+    }
+    for (const Node& node : entry.path) {
+        if (node.x == x && node.y == y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PathCache::erase(EntryList::iterator it) {
+    lookup.erase(it->key);
+    entries.erase(it);
+}
+
+void PathCache::clear() {
+    entries.clear();
+    lookup.clear();
+}
+
+void PathCache::resetStats() {
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+    stats.invalidations = 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Grid.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Bounded LRU cache of 4-connected shortest paths in front of Pathfinding::findPath,
+// keyed on (start, goal). Each entry remembers the grid version it is known to be
+// valid at. Edits arriving through the Grid observer hook drop only the entries they
+// can affect and bring the rest up to the new version:
+//  - a cell that becomes an obstacle drops the paths that run through it;
+//  - a cell that becomes free, or cheaper, drops the paths it could shorten, that is
+//    those whose cost exceeds the Manhattan distance from start to goal via that cell
+//    (every step costs at least 1), and every cached "no path" answer;
+//  - a cost change on a free cell also drops the paths that run through it.
+// Any other version change (e.g. assigning another grid) makes entries stale on lookup.
+// Not thread-safe; use one cache per thread.
+class PathCache : public GridObserver {
+public:
+    struct Stats {
+        size_t hits;
+        size_t misses;
+        size_t evictions;     // least recently used entries dropped to stay within capacity
+        size_t invalidations; // entries dropped because of grid edits
+    };
+
+    // Misses run Pathfinding::findPath in the given mode (AStar or JumpPoint)
+    PathCache(Grid& grid, size_t capacity = 1024, SearchMode mode = SearchMode::AStar);
+    ~PathCache();
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    // Empty, and neither cached nor counted, when start or end lies outside the grid
+    std::vector<Node> findPath(const Node& start, const Node& end);
+    void onCellChanged(int x, int y) override;
+    void clear();
+
+    size_t size() const { return entries.size(); }
+    size_t getCapacity() const { return capacity; }
+    const Stats& getStats() const { return stats; }
+    void resetStats();
+private:
+    struct Entry {
+        std::uint64_t key;
+        int startX, startY;
+        int goalX, goalY;
+        int length;            // path cost (steps without terrain costs), -1 when the goal was unreachable
+        std::uint64_t version; // grid version the path is known to be valid at
+        std::vector<Node> path;
+    };
+    typedef std::list<Entry> EntryList;
+
+    // Whether changing (x, y) to the given state can make the entry wrong
+    static bool affectedBy(const Entry& entry, int x, int y, bool blocked);
+    void erase(EntryList::iterator it);
+
+    Grid& grid;
+    size_t capacity;
+    SearchMode mode;
+    SearchState state;
+    EntryList entries; // most recently used first
+    std::unordered_map<std::uint64_t, EntryList::iterator> lookup;
+    Stats stats;
+};
@@ -0,0 +1,206 @@
+#include "PathService.h"
+
+PathService::PathService(std::function<void()> wake)
+    : wake(wake), nextId(1), runningId(0), runningCancelled(false), stopping(false),
+      trackedStart(0, 0), trackedEnd(0, 0) {
+    worker = std::thread(&PathService::workerLoop, this);
+}
+
+PathService::~PathService() {
+    stop();
+}
+
+void PathService::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        runningCancelled = true;
+    }
+    work.notify_all();
+    worker.join();
+}
+
+unsigned PathService::submit(const Grid& grid, const Node& start, const Node& end, Callback done,
+                             std::chrono::milliseconds budget, SearchMode mode) {
+    Job job = { 0, Job::Search, grid.snapshot(), 0, 0, 0, start, end, mode, grid.getVersion(),
+                std::chrono::steady_clock::time_point::max(), false, done };
+    return enqueue(std::move(job), budget);
+}
+
+unsigned PathService::track(const Grid& grid, const Node& start, const Node& end, Callback done,
+                            std::chrono::milliseconds budget) {
+    Job job = { 0, Job::Track, grid.snapshot(), 0, 0, 0, start, end, SearchMode::AStar, grid.getVersion(),
+                std::chrono::steady_clock::time_point::max(), false, done };
+    return enqueue(std::move(job), budget);
+}
+
+unsigned PathService::cellChanged(const Grid& grid, int x, int y, Callback done,
+                                  std::chrono::milliseconds budget) {
+    // Only the cell travels, not a snapshot
+    Job job = { 0, Job::Edit, std::shared_ptr<const Grid>(), x, y, grid.getCost(x, y), Node(x, y), Node(x, y), SearchMode::AStar,
+                grid.getVersion(), std::chrono::steady_clock::time_point::max(), false, done };
+    return enqueue(std::move(job), budget);
+}
+
+unsigned PathService::enqueue(Job job, std::chrono::milliseconds budget) {
+    if (budget.count() > 0) {
+        job.deadline = std::chrono::steady_clock::now() + budget;
+    }
+    unsigned id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        if (nextId == 0) {
+            nextId = 1; // 0 means no job
+        }
+        job.id = id;
+        queue.push_back(std::move(job));
+    }
+    work.notify_one();
+    return id;
+}
+
+void PathService::cancel(unsigned job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (job == runningId) {
+        runningCancelled = true;
+        return;
+    }
+    for (Job& queued : queue) {
+        if (queued.id == job) {
+            queued.cancelled = true;
+            return;
+        }
+    }
+    // Finished but not polled yet: the answer is no longer wanted
+    for (Finished& done : finished) {
+        if (done.result.job == job) {
+            done.result.status = PathResult::Cancelled;
+            done.result.path.clear();
+            return;
+        }
+    }
+}
+
+void PathService::cancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (runningId != 0) {
+        runningCancelled = true;
+    }
+    for (Job& queued : queue) {
+        queued.cancelled = true;
+    }
+    for (Finished& done : finished) {
+        done.result.status = PathResult::Cancelled;
+        done.result.path.clear();
+    }
+}
+
+size_t PathService::poll() {
+    std::deque<Finished> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(finished);
+    }
+    // Callbacks run unlocked, so they may submit or cancel jobs
+    for (Finished& done : ready) {
+        if (done.done) {
+            done.done(done.result);
+        }
+    }
+    return ready.size();
+}
+
+void PathService::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        runningId = job.id;
+        runningCancelled = job.cancelled;
+        lock.unlock();
+
+        PathResult result = { job.id, PathResult::Cancelled, std::vector<Node>(), job.gridVersion, 0 };
+        if (job.kind != Job::Search) {
+            runIncremental(job, result);
+        }
+        else if (!runningCancelled) {
+            state.setStopCondition(&runningCancelled, job.deadline);
+            result.path = Pathfinding::findPath(*job.grid, job.start, job.end, state, job.mode);
+            result.expanded = state.getExpanded();
+            if (!result.path.empty()) {
+                result.status = PathResult::Found;
+            }
+            else if (!job.grid->isReachable(job.start.x, job.start.y, job.end.x, job.end.y)) {
+                result.status = PathResult::Unreachable;
+            }
+            else {
+                result.status = state.wasStopped() ? PathResult::TimedOut : PathResult::NoPath;
+            }
+        }
+
+        lock.lock();
+        runningId = 0;
+        if (runningCancelled) {
+            // Also covers a cancel that arrived after the search had finished
+            result.status = PathResult::Cancelled;
+            result.path.clear();
+        }
+        Finished done = { std::move(result), std::move(job.done) };
+        finished.push_back(std::move(done));
+        if (wake && !stopping) {
+            lock.unlock();
+            wake();
+            lock.lock();
+        }
+    }
+}
+
+void PathService::runIncremental(Job& job, PathResult& result) {
+    // The copy and the query are updated even for cancelled jobs; only the repair is skipped
+    if (job.kind == Job::Track) {
+        planner.reset();
+        tracked.reset(new Grid(*job.grid)); // edited from here on, so not shared
+        trackedStart = job.start;
+        trackedEnd = job.end;
+        int width = tracked->getWidth();
+        int height = tracked->getHeight();
+        if (job.start.x < 0 || job.start.y < 0 || job.start.x >= width || job.start.y >= height ||
+            job.end.x < 0 || job.end.y < 0 || job.end.x >= width || job.end.y >= height) {
+            tracked.reset();
+            result.status = PathResult::Unreachable;
+            return;
+        }
+        planner.reset(new DStarLite(*tracked));
+        planner->plan(job.start, job.end);
+    }
+    else if (!planner) {
+        return; // nothing tracked; the edit reaches the next track() with its snapshot
+    }
+    else {
+        tracked->setCost(job.x, job.y, job.cost); // 0 blocks the cell, anything else frees it
+    }
+    if (runningCancelled) {
+        return;
+    }
+
+    planner->setStopCondition(&runningCancelled, job.deadline);
+    result.path = planner->getPath();
+    result.expanded = planner->getExpanded();
+    if (!result.path.empty()) {
+        result.status = PathResult::Found;
+    }
+    else if (!tracked->isReachable(trackedStart.x, trackedStart.y, trackedEnd.x, trackedEnd.y)) {
+        result.status = PathResult::Unreachable;
+    }
+    else {
+        result.status = planner->wasStopped() ? PathResult::TimedOut : PathResult::NoPath;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "DStarLite.h"
+#include "Grid.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct PathResult {
+    // Unreachable: start and end are blocked or in separate regions, answered without searching
+    enum Status { Found, NoPath, Unreachable, Cancelled, TimedOut };
+
+    unsigned job;
+    Status status;
+    std::vector<Node> path;    // empty unless Found
+    std::uint64_t gridVersion; // version of the grid the job was submitted against
+    size_t expanded;
+};
+
+// Runs path queries on a worker thread so that the caller's event loop never blocks.
+// Each job searches a snapshot of the grid taken at submit() (Grid::snapshot(), so jobs
+// submitted between two edits share one copy), and the caller can keep editing its grid
+// meanwhile; compare PathResult::gridVersion to spot stale answers.
+// Results are handed back on the caller's thread: the worker calls wake (from its own
+// thread) when results are waiting, and the next poll() runs their callbacks.
+// Jobs can be cancelled at any point, and each may have a time budget counted from
+// submit(); a running search notices either within a few hundred expansions.
+// For a query that outlives edits, track() keeps a D* Lite search (see DStarLite) on the
+// worker over the worker's own copy of the grid (made on the worker); cellChanged() forwards each edit to that
+// copy, and the search repairs only what the edit affected instead of starting over.
+class PathService {
+public:
+    typedef std::function<void(const PathResult&)> Callback;
+
+    // wake may be empty, e.g. when the caller polls every frame anyway
+    explicit PathService(std::function<void()> wake = std::function<void()>());
+    // Stops the service; callbacks that have not been polled yet never run
+    ~PathService();
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    // Queue a search from start to end; a budget of zero means no deadline. Returns the job id.
+    unsigned submit(const Grid& grid, const Node& start, const Node& end, Callback done,
+                    std::chrono::milliseconds budget = std::chrono::milliseconds(0), SearchMode mode = SearchMode::AStar);
+    // Start the incremental query, replacing any earlier one; its first path arrives like a
+    // submit() result. The worker's copy of the grid is taken from grid now.
+    unsigned track(const Grid& grid, const Node& start, const Node& end, Callback done,
+                   std::chrono::milliseconds budget = std::chrono::milliseconds(0));
+    // Forward an edit of cell (x, y) of grid (the one given to track()) and repair the
+    // incremental query; done gets the new path. Cancelling the job skips the repair but
+    // never the edit, so the copy stays in step; a stopped repair resumes with the next one.
+    // Edits are dropped while nothing is tracked.
+    unsigned cellChanged(const Grid& grid, int x, int y, Callback done,
+                         std::chrono::milliseconds budget = std::chrono::milliseconds(0));
+    // The job's callback still runs, with status Cancelled, unless it already has
+    void cancel(unsigned job);
+    void cancelAll();
+    // Run the callbacks of finished jobs on the calling thread; returns how many ran
+    size_t poll();
+    // Cancel everything and join the worker, after which wake is never called again.
+    // The destructor does this too; call it early when wake must not outlive something.
+    // Jobs submitted afterwards are never run.
+    void stop();
+private:
+    struct Job {
+        enum Kind { Search, Track, Edit };
+
+        unsigned id;
+        Kind kind;
+        std::shared_ptr<const Grid> grid; // Search and Track
+        int x, y, cost;             // Edit; cost 0 for an obstacle
+        Node start;
+        Node end;
+        SearchMode mode;
+        std::uint64_t gridVersion; // of the caller's grid; the snapshot starts its own count
+        std::chrono::steady_clock::time_point deadline;
+        bool cancelled;
+        Callback done;
+    };
+    struct Finished {
+        PathResult result;
+        Callback done;
+    };
+
+    unsigned enqueue(Job job, std::chrono::milliseconds budget);
+    void workerLoop();
+    // Run a Track or Edit job against the incremental query
+    void runIncremental(Job& job, PathResult& result);
+
+    std::function<void()> wake;
+    std::mutex mutex;
+    std::condition_variable work;
+    std::deque<Job> queue;
+    std::deque<Finished> finished;
+    unsigned nextId;
+    unsigned runningId;        // 0 when idle
+    std::atomic<bool> runningCancelled;
+    bool stopping;
+    SearchState state;         // used by the worker only
+    // The incremental query, used by the worker only; planner observes tracked
+    std::unique_ptr<Grid> tracked;
+    std::unique_ptr<DStarLite> planner;
+    Node trackedStart;
+    Node trackedEnd;
+    std::thread worker;
+};
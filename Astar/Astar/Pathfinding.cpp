@@ -1,66 +1,44 @@
-#include "Pathfinding.h"
-#include <cmath>
-#include <queue>
-#include <algorithm>
-
-std::vector<Node*> Pathfinding::openList_container;
-
-std::vector<Node*> Pathfinding::findPath(const Grid& grid, const Node& start, const Node& end) {
-    std::priority_queue<Node*, std::vector<Node*>, CompareNodes> openList;
-    std::vector<Node*> closedList;
-
-    openList.push(new Node(start.x, start.y));
-    openList_container.push_back(new Node(start.x, start.y)); // Initialize openList_container
-
-    while (!openList.empty()) {
-        Node* current = openList.top();
-        openList.pop();
-
-        if (*current == end) {
-            // Reconstruct path and return
-            std::vector<Node*> path;
-            while (current != nullptr) {
-                path.push_back(current);
-                current = current->parent;
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
-
-        closedList.push_back(current);
-
-        // Explore neighboring nodes
-        for (auto neighbor : getNeighbors(*current, grid)) {
-            if (std::find(closedList.begin(), closedList.end(), neighbor) != closedList.end()) {
-                delete neighbor;
-                continue;
-            }
-
-            float tentative_g = current->g + 1;
-
-            auto it = std::find_if(openList_container.begin(), openList_container.end(), [&](Node* n) { return *n == *neighbor; });
-            if (it == openList_container.end() || tentative_g < neighbor->g) {
-                neighbor->g = tentative_g;
-                neighbor->h = heuristic(*neighbor, end);
-                neighbor->parent = current;
-
-                if (it == openList_container.end()) {
-                    openList.push(neighbor);
-                    openList_container.push_back(neighbor);
-                }
-            }
-        }
-    }
-
-    return std::vector<Node*>();
-}
-
-float Pathfinding::heuristic(const Node& a, const Node& b) {
-    return std::abs(a.x - b.x) + std::abs(a.y - b.y);
-}
-
-std::vector<Node*> Pathfinding::getNeighbors(const Node& node, const Grid& grid) {
-    std::vector<Node*> neighbors;
-    // Implement the logic to get neighboring nodes
-    return neighbors;
-}
+#include "Pathfinding.h"
+#include "BidirectionalSearch.h"
+#include "JumpPointSearch.h"
+#include <algorithm>
+
+thread_local SearchState Pathfinding::threadState;
+
+std::vector<Node> Pathfinding::findPath(const Grid& grid, const Node& start, const Node& end, SearchMode mode, const JumpTable* jumpTable) {
+    return findPath(grid, start, end, threadState, mode, jumpTable);
+}
+
+std::vector<Node> Pathfinding::findPath(const Grid& grid, const Node& start, const Node& end, SearchState& state, SearchMode mode, const JumpTable* jumpTable) {
+    if (grid.hasCosts()) {
+        // Jump points, jump tables and the bidirectional stopping rule all assume unit steps
+        return findPath<WeightedFourConnected, Manhattan>(grid, start, end, state);
+    }
+    switch (mode) {
+    case SearchMode::JumpPoint:
+        return JumpPointSearch::findPath(grid, start, end, state, nullptr);
+    case SearchMode::JumpPointPlus:
+        // A table from before an edit would jump through new walls, and one for another
+        // grid size would read past its end; plain JPS finds the jumps itself
+        return JumpPointSearch::findPath(grid, start, end, state, jumpTable && jumpTable->matches(grid) ? jumpTable : nullptr);
+    case SearchMode::Bidirectional: {
+        // Each calling thread gets its own helper thread, started on first use
+        thread_local BidirectionalSearch bidirectional;
+        return bidirectional.findPath<FourConnected, Manhattan>(grid, start, end, &state);
+    }
+    default:
+        return findPath<FourConnected, Manhattan>(grid, start, end, state);
+    }
+}
+
+std::vector<Node> Pathfinding::buildPath(const SearchState& state, int endIndex) {
+    int width = state.getWidth();
+    std::vector<Node> path;
+    for (int index = endIndex; index != -1; index = state.getParent(index)) {
+        Node node(index % width, index / width);
+        node.g = state.getG(index);
+        path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
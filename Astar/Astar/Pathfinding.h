@@ -1,27 +1,140 @@
-#pragma once
-#include "Grid.h"
-#include <vector>
-
-struct Node {
-    int x, y;
-    float g, h;
-    Node* parent;
-    Node(int x, int y) : x(x), y(y), g(0), h(0), parent(nullptr) {}
-    float f() const { return g + h; }
-    bool operator==(const Node& other) const { return x == other.x && y == other.y; }
-};
-
-struct CompareNodes {
-    bool operator()(Node* a, Node* b) {
-        return a->f() > b->f();
-    }
-};
-
-class Pathfinding {
-public:
-    static std::vector<Node*> findPath(const Grid& grid, const Node& start, const Node& end);
-private:
-    static float heuristic(const Node& a, const Node& b);
-    static std::vector<Node*> getNeighbors(const Node& node, const Grid& grid);
-    static std::vector<Node*> openList_container; // Define openList_container here
-};
+#pragma once
+#include "Grid.h"
+#include "JumpTable.h"
+#include "SearchPolicies.h"
+#include "SearchState.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+struct Node {
+    int x, y;
+    int g, h;
+    Node(int x, int y) : x(x), y(y), g(0), h(0) {}
+    int f() const { return g + h; }
+    bool operator==(const Node& other) const { return x == other.x && y == other.y; }
+};
+
+// Once grid.hasCosts() is true, every mode (JumpPoint, JumpPointPlus and Bidirectional
+// included) quietly runs weighted 4-connected A* instead: their jumps and stopping rules
+// assume unit steps. hasCosts() stays true after the costs are set back to 1.
+enum class SearchMode {
+    AStar,        // plain A*, 4-connected with the Manhattan heuristic
+    JumpPoint,    // Jump Point Search, jumps found by scanning the grid
+    JumpPointPlus, // JPS+, jumps read from a JumpTable built for the grid; plain JumpPoint
+                   // when there is no table or the grid has changed since it was built
+    Bidirectional  // A* from both ends at once on two threads (see BidirectionalSearch). Not a
+                   // speed-up: no gain on mazes, about 3x slower than AStar on open maps.
+};
+
+class Pathfinding {
+public:
+    // Uses a search state owned by the calling thread
+    static std::vector<Node> findPath(const Grid& grid, const Node& start, const Node& end,
+                                      SearchMode mode = SearchMode::AStar, const JumpTable* jumpTable = nullptr);
+    // Uses the caller's search state; nothing is allocated once it has grown to the grid size.
+    // Bidirectional searches keep their own per-thread states for the two frontiers; state
+    // supplies the stop condition and gets wasStopped() and the expansions of both.
+    static std::vector<Node> findPath(const Grid& grid, const Node& start, const Node& end, SearchState& state,
+                                      SearchMode mode = SearchMode::AStar, const JumpTable* jumpTable = nullptr);
+
+    // A* specialised at compile time for a neighbor policy and a heuristic policy
+    // (see SearchPolicies.h), e.g. findPath<EightConnectedNoCorners, Octile>. The grid can
+    // be a Grid or a TiledGrid.
+    template <typename Neighbors, typename Heuristic, typename GridType>
+    static std::vector<Node> findPath(const GridType& grid, const Node& start, const Node& end) {
+        return findPath<Neighbors, Heuristic>(grid, start, end, threadState);
+    }
+    template <typename Neighbors, typename Heuristic, typename GridType>
+    static std::vector<Node> findPath(const GridType& grid, const Node& start, const Node& end, SearchState& state) {
+        return findPathWith<Neighbors>(grid, start, end, state, OffsetHeuristic<Heuristic>());
+    }
+    // A* with a heuristic object, for heuristics that need more than the offset to the goal
+    // (e.g. Landmarks::Heuristic). It provides
+    //   template <typename Neighbors> int estimate(int index, int dx, int dy) const
+    // for the cell index and its |dx|, |dy| offset from the goal.
+    template <typename Neighbors, typename GridType, typename HeuristicObject>
+    static std::vector<Node> findPathWith(const GridType& grid, const Node& start, const Node& end, SearchState& state,
+                                          const HeuristicObject& heuristic);
+private:
+    // Adapts a heuristic policy to the heuristic object interface
+    template <typename Heuristic>
+    struct OffsetHeuristic {
+        template <typename Neighbors>
+        int estimate(int, int dx, int dy) const { return Heuristic::template estimate<Neighbors>(dx, dy); }
+    };
+
+    static std::vector<Node> buildPath(const SearchState& state, int endIndex);
+    static thread_local SearchState threadState;
+};
+
+template <typename Neighbors, typename GridType, typename HeuristicObject>
+std::vector<Node> Pathfinding::findPathWith(const GridType& grid, const Node& start, const Node& end, SearchState& state,
+                                            const HeuristicObject& heuristic) {
+    int width = grid.getWidth();
+    state.begin(width, grid.getHeight());
+    // The grid's regions are 4-connected, so they only rule a query out for policies that never cut corners
+    if (!grid.isPassable(start.x, start.y) || !grid.isPassable(end.x, end.y) ||
+        (!Neighbors::CUTS_CORNERS && !grid.isReachable(start.x, start.y, end.x, end.y))) {
+        state.finish(); // still counted in the stats, with no expansions
+        return std::vector<Node>();
+    }
+    // Every policy raises f by less than 512 per step (see SearchPolicies.h), so keys fit the bucket queue
+    SearchState::BucketList& openList = state.getBucketList();
+    openList.reset(width * grid.getHeight());
+
+    int startIndex = start.y * width + start.x;
+    int endIndex = end.y * width + end.x;
+    state.open(startIndex, 0, -1);
+    openList.push(startIndex, heuristic.template estimate<Neighbors>(startIndex, std::abs(start.x - end.x), std::abs(start.y - end.y)), 0);
+    state.recordPush(openList.size());
+    state.startPhase(SearchStats::SEARCH);
+
+    while (!openList.empty()) {
+        OpenEntry current = openList.pop();
+        state.close(current.index);
+        state.traceExpand(current.index, current.f);
+
+        if (current.index == endIndex) {
+            state.startPhase(SearchStats::PATH);
+            std::vector<Node> path = buildPath(state, endIndex);
+            state.finish();
+            return path;
+        }
+        if (state.shouldStop()) {
+            break;
+        }
+
+        int neighbors[8];
+        int costs[8];
+        int count = Neighbors::expand(grid, current.index, neighbors, costs);
+        for (int i = 0; i < count; ++i) {
+            int neighbor = neighbors[i];
+            int tentative_g = current.g + costs[i];
+            // With a consistent heuristic closed cells are never improved on, so they are
+            // only reopened when the heuristic is not consistent
+            if (state.isVisited(neighbor) && tentative_g >= state.getG(neighbor)) {
+                continue;
+            }
+
+            int f = tentative_g + heuristic.template estimate<Neighbors>(neighbor, std::abs(neighbor % width - end.x), std::abs(neighbor / width - end.y));
+            bool queued = state.isOpen(neighbor);
+            if (!queued && state.isVisited(neighbor)) {
+                state.recordReopen();
+            }
+            state.open(neighbor, tentative_g, current.index);
+            state.traceNeighbor(neighbor, tentative_g, f);
+            if (queued) {
+                openList.decreaseKey(neighbor, f, tentative_g);
+                state.recordDecreaseKey();
+            }
+            else {
+                openList.push(neighbor, f, tentative_g);
+                state.recordPush(openList.size());
+            }
+        }
+    }
+
+    state.finish();
+    return std::vector<Node>();
+}
@@ -1,11 +1,301 @@
-#include "Renderer.h"
-
-Renderer::Renderer(SDL_Renderer* renderer, int cellSize) : renderer(renderer), cellSize(cellSize) {}
-
-void Renderer::render(const Grid& grid, const std::vector<Node*>& path) const {
-    // Implement rendering logic
-}
-
-void Renderer::renderAxis(int width, int height) const {
-    // Implement axis rendering logic
-}
+#include "Renderer.h"
+#include <algorithm>
+
+namespace {
+    const int PATH_THICKNESS = 3;
+    // Past this many dirty blocks a full redraw of the cache is cheaper
+    const size_t MAX_DIRTY = 64;
+
+    // Seven-segment digits for the axis labels: {x, y, w, h} per segment, unused segments are empty
+    const int SEGMENT_LENGTH = 5;
+    const int SEGMENT_WIDTH = 1;
+    const int L = SEGMENT_LENGTH;
+    const int W = SEGMENT_WIDTH;
+    const int SEGMENTS[10][7][4] = {
+        {{0, 0, L, W}, {0, 0, W, L}, {L, 0, W, L}, {0, L, L, W}, {0, L, W, L}, {L, L, W, L}, {0, L * 2, L, W}}, // 0
+        {{L, 0, W, L}, {L, L, W, L}}, // 1
+        {{0, 0, L, W}, {L, 0, W, L}, {0, L, L, W}, {0, L, W, L}, {0, L * 2, L, W}}, // 2
+        {{0, 0, L, W}, {L, 0, W, L}, {0, L, L, W}, {L, L, W, L}, {0, L * 2, L, W}}, // 3
+        {{0, 0, W, L}, {L, 0, W, L}, {0, L, L, W}, {L, L, W, L}}, // 4
+        {{0, 0, L, W}, {0, 0, W, L}, {0, L, L, W}, {L, L, W, L}, {0, L * 2, L, W}}, // 5
+        {{0, 0, L, W}, {0, 0, W, L}, {0, L, L, W}, {0, L, W, L}, {L, L, W, L}, {0, L * 2, L, W}}, // 6
+        {{0, 0, L, W}, {L, 0, W, L}, {L, L, W, L}}, // 7
+        {{0, 0, L, W}, {0, 0, W, L}, {L, 0, W, L}, {0, L, L, W}, {0, L, W, L}, {L, L, W, L}, {0, L * 2, L, W}}, // 8
+        {{0, 0, L, W}, {0, 0, W, L}, {L, 0, W, L}, {0, L, L, W}, {L, L, W, L}, {0, L * 2, L, W}} // 9
+    };
+
+    void addDigit(std::vector<SDL_Rect>& rects, int digit, int x, int y) {
+        for (const auto& segment : SEGMENTS[digit]) {
+            if (segment[2] > 0) {
+                SDL_Rect rect = { x + segment[0], y + segment[1], segment[2], segment[3] };
+                rects.push_back(rect);
+            }
+        }
+    }
+}
+
+Renderer::Renderer(SDL_Renderer* renderer, Grid& grid, int cellSize)
+    : renderer(renderer), grid(grid), cellSize(cellSize), gridTexture(nullptr), axisTexture(nullptr), flowField(nullptr),
+      cacheFailed(false), fullRedraw(true) {
+    grid.addObserver(this);
+}
+
+Renderer::~Renderer() {
+    release();
+    grid.removeObserver(this);
+}
+
+void Renderer::release() {
+    if (gridTexture) {
+        SDL_DestroyTexture(gridTexture);
+        gridTexture = nullptr;
+    }
+    if (axisTexture) {
+        SDL_DestroyTexture(axisTexture);
+        axisTexture = nullptr;
+    }
+    fullRedraw = true;
+}
+
+void Renderer::invalidate(const SDL_Rect& cells) {
+    if (!fullRedraw) {
+        dirty.push_back(cells);
+        if (dirty.size() > MAX_DIRTY) {
+            fullRedraw = true;
+        }
+    }
+}
+
+void Renderer::invalidate() {
+    fullRedraw = true;
+}
+
+void Renderer::onCellChanged(int x, int y) {
+    SDL_Rect cell = { x, y, 1, 1 };
+    invalidate(cell);
+}
+
+bool Renderer::ensureTextures() {
+    if (gridTexture) {
+        return true;
+    }
+    if (cacheFailed || !SDL_RenderTargetSupported(renderer)) {
+        cacheFailed = true;
+        return false;
+    }
+    int width = grid.getWidth() * cellSize;
+    int height = grid.getHeight() * cellSize;
+    gridTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    axisTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!gridTexture || !axisTexture) {
+        // Most likely larger than the renderer's maximum texture size
+        release();
+        cacheFailed = true;
+        return false;
+    }
+    SDL_SetTextureBlendMode(axisTexture, SDL_BLENDMODE_BLEND);
+    fullRedraw = true;
+    return true;
+}
+
+void Renderer::render(const std::vector<Node>& path, const Node* start, const Node* end) {
+    SDL_Rect all = { 0, 0, grid.getWidth(), grid.getHeight() };
+    if (ensureTextures()) {
+        if (fullRedraw || !dirty.empty()) {
+            SDL_SetRenderTarget(renderer, gridTexture);
+            if (fullRedraw) {
+                drawCells(all);
+            }
+            else {
+                for (const SDL_Rect& cells : dirty) {
+                    drawCells(cells);
+                }
+            }
+            if (fullRedraw) {
+                // The labels only depend on the grid size
+                SDL_SetRenderTarget(renderer, axisTexture);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+                SDL_RenderClear(renderer);
+                drawAxis();
+            }
+            SDL_SetRenderTarget(renderer, nullptr);
+        }
+        SDL_RenderCopy(renderer, gridTexture, nullptr, nullptr);
+    }
+    else {
+        drawCells(all);
+    }
+    fullRedraw = false;
+    dirty.clear();
+
+    drawFlowField();
+    drawMarker(start, 255, 0, 0); // Red for the start node
+    drawMarker(end, 0, 0, 255);   // Blue for the destination node
+    drawPath(path);
+
+    // Labels go on top of everything else
+    if (axisTexture) {
+        SDL_RenderCopy(renderer, axisTexture, nullptr, nullptr);
+    }
+    else {
+        drawAxis();
+    }
+}
+
+void Renderer::drawCells(const SDL_Rect& cells) {
+    int x0 = std::max(cells.x, 0);
+    int y0 = std::max(cells.y, 0);
+    int x1 = std::min(cells.x + cells.w, grid.getWidth());
+    int y1 = std::min(cells.y + cells.h, grid.getHeight());
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // White background, then one black rect per run of obstacles in a row
+    SDL_Rect area = { x0 * cellSize, y0 * cellSize, (x1 - x0) * cellSize, (y1 - y0) * cellSize };
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRect(renderer, &area);
+    if (grid.hasCosts()) {
+        // Cells that cost more than 1, one batch per band of costs: below 4, 16, 64 and up to 255
+        static const Uint8 shades[TERRAIN_SHADES][3] = { { 235, 225, 200 }, { 210, 190, 150 }, { 170, 145, 105 }, { 125, 100, 70 } };
+        for (std::vector<SDL_Rect>& band : terrain) {
+            band.clear();
+        }
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                int cost = grid.getCost(x, y);
+                if (cost > 1) {
+                    int band = cost < 4 ? 0 : cost < 16 ? 1 : cost < 64 ? 2 : 3;
+                    SDL_Rect cell = { x * cellSize, y * cellSize, cellSize, cellSize };
+                    terrain[band].push_back(cell);
+                }
+            }
+        }
+        for (int band = 0; band < TERRAIN_SHADES; ++band) {
+            if (!terrain[band].empty()) {
+                SDL_SetRenderDrawColor(renderer, shades[band][0], shades[band][1], shades[band][2], 255);
+                SDL_RenderFillRects(renderer, terrain[band].data(), static_cast<int>(terrain[band].size()));
+            }
+        }
+    }
+    rects.clear();
+    for (int y = y0; y < y1; ++y) {
+        for (int x = grid.nextObstacleInRow(x0, y); x < x1; ) {
+            int runEnd = x + 1;
+            while (runEnd < x1 && grid.isObstacle(runEnd, y)) {
+                ++runEnd;
+            }
+            SDL_Rect run = { x * cellSize, y * cellSize, (runEnd - x) * cellSize, cellSize };
+            rects.push_back(run);
+            x = runEnd < x1 ? grid.nextObstacleInRow(runEnd, y) : x1;
+        }
+    }
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    if (!rects.empty()) {
+        SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+    }
+
+    // Every cell has a one pixel outline, so each border between cells is two pixels wide.
+    // Vertical and horizontal lines are each one polyline that zigzags along the edges of
+    // the block, which are grid lines themselves.
+    int top = area.y;
+    int bottom = area.y + area.h - 1;
+    int left = area.x;
+    int right = area.x + area.w - 1;
+    points.clear();
+    for (int x = x0; x < x1; ++x) {
+        int edges[2] = { x * cellSize, x * cellSize + cellSize - 1 };
+        for (int edge : edges) {
+            bool down = points.size() % 4 == 0;
+            SDL_Point a = { edge, down ? top : bottom };
+            SDL_Point b = { edge, down ? bottom : top };
+            points.push_back(a);
+            points.push_back(b);
+        }
+    }
+    SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
+    points.clear();
+    for (int y = y0; y < y1; ++y) {
+        int edges[2] = { y * cellSize, y * cellSize + cellSize - 1 };
+        for (int edge : edges) {
+            bool across = points.size() % 4 == 0;
+            SDL_Point a = { across ? left : right, edge };
+            SDL_Point b = { across ? right : left, edge };
+            points.push_back(a);
+            points.push_back(b);
+        }
+    }
+    SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
+}
+
+void Renderer::drawAxis() {
+    rects.clear();
+    for (int i = 0; i < grid.getWidth(); ++i) {
+        addDigit(rects, i % 10, i * cellSize + cellSize / 3, 0);
+    }
+    for (int i = 0; i < grid.getHeight(); ++i) {
+        addDigit(rects, i % 10, 0, i * cellSize + cellSize / 3);
+    }
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+}
+
+void Renderer::drawPath(const std::vector<Node>& path) {
+    if (path.size() < 2) {
+        return;
+    }
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for the path
+
+    // One polyline through the cell centres per offset; the offsets fan out along both diagonals
+    for (int w = -PATH_THICKNESS / 2; w <= PATH_THICKNESS / 2; ++w) {
+        int offsets[4][2] = { { -w, -w }, { w, w }, { -w, w }, { w, -w } };
+        int count = w == 0 ? 1 : 4;
+        for (int i = 0; i < count; ++i) {
+            points.clear();
+            for (const Node& node : path) {
+                SDL_Point point = { node.x * cellSize + cellSize / 2 + offsets[i][0], node.y * cellSize + cellSize / 2 + offsets[i][1] };
+                points.push_back(point);
+            }
+            SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
+        }
+    }
+}
+
+void Renderer::drawFlowField() {
+    if (!flowField || !flowField->isBuilt()) {
+        return;
+    }
+    // Each arrow is a stem from the cell centre towards the next cell and a square head at
+    // its tip, all in one batch
+    int stem = cellSize * 2 / 5;
+    int head = std::max(cellSize / 6, 2);
+    rects.clear();
+    for (int y = 0; y < grid.getHeight(); ++y) {
+        for (int x = 0; x < grid.getWidth(); ++x) {
+            unsigned direction = flowField->getDirection(x, y);
+            if (direction == 0) {
+                continue;
+            }
+            int dx = direction == Grid::RIGHT ? 1 : direction == Grid::LEFT ? -1 : 0;
+            int dy = direction == Grid::DOWN ? 1 : direction == Grid::UP ? -1 : 0;
+            int cx = x * cellSize + cellSize / 2;
+            int cy = y * cellSize + cellSize / 2;
+            SDL_Rect line = { std::min(cx, cx + dx * stem) - (dx ? 0 : 1), std::min(cy, cy + dy * stem) - (dy ? 0 : 1), dx ? stem : 2, dy ? stem : 2 };
+            SDL_Rect tip = { cx + dx * stem - head / 2, cy + dy * stem - head / 2, head, head };
+            rects.push_back(line);
+            rects.push_back(tip);
+        }
+    }
+    if (!rects.empty()) {
+        SDL_SetRenderDrawColor(renderer, 90, 140, 230, 255); // Light blue for the flow field
+        SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+    }
+}
+
+void Renderer::drawMarker(const Node* node, Uint8 r, Uint8 g, Uint8 b) {
+    if (node) {
+        SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+        SDL_Rect rect = { node->x * cellSize, node->y * cellSize, cellSize, cellSize };
+        SDL_RenderFillRect(renderer, &rect);
+    }
+}
@@ -1,14 +1,60 @@
-#pragma once
-#include "Grid.h"
-#include "Pathfinding.h"
-#include <SDL.h>
-
-class Renderer {
-public:
-    Renderer(SDL_Renderer* renderer, int cellSize);
-    void render(const Grid& grid, const std::vector<Node*>& path) const;
-    void renderAxis(int width, int height) const;
-private:
-    SDL_Renderer* renderer;
-    int cellSize;
-};
+#pragma once
+#include "FlowField.h"
+#include "Grid.h"
+#include "Pathfinding.h"
+#include <SDL.h>
+#include <vector>
+
+// Draws the grid (with terrain costs as shades of brown), axis labels, current path,
+// start/goal markers and optionally a flow field as one arrow per cell.
+// The cells, grid lines and labels only change with the grid, so they are drawn once
+// into cached target textures and copied to the screen each frame. Obstacle edits
+// arrive through the Grid observer hook and redraw just the changed cells; anything
+// else that draws over the cache can mark an area dirty with invalidate().
+// All drawing is batched into SDL_RenderFillRects/SDL_RenderDrawLines calls. When
+// the renderer has no target texture support, or the grid is too large for one
+// texture, the static layer is drawn straight to the screen every frame instead.
+class Renderer : public GridObserver {
+public:
+    Renderer(SDL_Renderer* renderer, Grid& grid, int cellSize);
+    ~Renderer();
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // Draw a frame (without presenting it); start and end may be null
+    void render(const std::vector<Node>& path, const Node* start, const Node* end);
+    // Redraw the given cells (in cell coordinates) on the next frame
+    void invalidate(const SDL_Rect& cells);
+    // Redraw everything on the next frame, e.g. after SDL_RENDER_TARGETS_RESET
+    void invalidate();
+    void onCellChanged(int x, int y) override;
+    // Draw the field's directions over the cells each frame; null to stop
+    void setFlowField(const FlowField* field) { flowField = field; }
+    // Free the cached textures; call before destroying the SDL renderer
+    void release();
+private:
+    static const int TERRAIN_SHADES = 4;
+
+    // Create the textures on first use; false when drawing has to go straight to the screen
+    bool ensureTextures();
+    // Cells and grid lines of a block of cells, onto the current render target
+    void drawCells(const SDL_Rect& cells);
+    void drawAxis();
+    void drawPath(const std::vector<Node>& path);
+    void drawFlowField();
+    void drawMarker(const Node* node, Uint8 r, Uint8 g, Uint8 b);
+
+    SDL_Renderer* renderer;
+    Grid& grid;
+    int cellSize;
+    SDL_Texture* gridTexture;
+    SDL_Texture* axisTexture;
+    const FlowField* flowField;
+    bool cacheFailed;
+    bool fullRedraw;
+    std::vector<SDL_Rect> dirty; // cell coordinates
+    // Scratch buffers for the batched calls
+    std::vector<SDL_Rect> rects;
+    std::vector<SDL_Point> points;
+    std::vector<SDL_Rect> terrain[TERRAIN_SHADES];
+};
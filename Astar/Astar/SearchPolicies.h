@@ -0,0 +1,127 @@
+#pragma once
+#include "Grid.h"
+#include <cmath>
+#include <cstdlib>
+
+// Compile-time policies for Pathfinding::findPath<Neighbors, Heuristic>.
+// Costs are integers. With diagonal moves a straight step costs 70 and a
+// diagonal one 99 (99/70 is within 0.004% of sqrt(2)); 4-connected search keeps
+// unit steps. Node::g values are in the units of the neighbor policy used.
+// One step may raise f by at most the step cost plus the heuristic's change, which
+// must stay below 512 for the bucket queue A* runs on (see BucketQueue.h).
+
+// Neighbor policies: fill the indices and step costs of the passable neighbors of a cell, return the count.
+// They work on any grid with Grid's query interface (Grid, TiledGrid).
+struct FourConnected {
+    static const int STRAIGHT_COST = 1;
+    static const int DIAGONAL_COST = 2; // two straight steps; no diagonal moves
+    static const bool CUTS_CORNERS = false; // moves connect the same cells as 4-connected ones
+
+    template <typename GridType>
+    static int expand(const GridType& grid, int index, int neighbors[8], int costs[8]) {
+        int width = grid.getWidth();
+        unsigned passable = grid.passableNeighbors4(index % width, index / width);
+        int count = 0;
+        if (passable & Grid::RIGHT) { neighbors[count] = index + 1; costs[count++] = STRAIGHT_COST; }
+        if (passable & Grid::DOWN) { neighbors[count] = index + width; costs[count++] = STRAIGHT_COST; }
+        if (passable & Grid::LEFT) { neighbors[count] = index - 1; costs[count++] = STRAIGHT_COST; }
+        if (passable & Grid::UP) { neighbors[count] = index - width; costs[count++] = STRAIGHT_COST; }
+        return count;
+    }
+};
+
+// 4-connected with the terrain costs of the grid (Grid::setCost): entering a cell costs
+// 1 to 255. STRAIGHT_COST is the cheapest step, so the heuristics stay admissible.
+struct WeightedFourConnected {
+    static const int STRAIGHT_COST = 1;
+    static const int DIAGONAL_COST = 2;
+    static const bool CUTS_CORNERS = false;
+
+    template <typename GridType>
+    static int expand(const GridType& grid, int index, int neighbors[8], int costs[8]) {
+        int width = grid.getWidth();
+        unsigned passable = grid.passableNeighbors4(index % width, index / width);
+        int count = 0;
+        if (passable & Grid::RIGHT) { neighbors[count] = index + 1; costs[count++] = grid.getStepCost(index + 1); }
+        if (passable & Grid::DOWN) { neighbors[count] = index + width; costs[count++] = grid.getStepCost(index + width); }
+        if (passable & Grid::LEFT) { neighbors[count] = index - 1; costs[count++] = grid.getStepCost(index - 1); }
+        if (passable & Grid::UP) { neighbors[count] = index - width; costs[count++] = grid.getStepCost(index - width); }
+        return count;
+    }
+};
+
+// Diagonal moves allowed whenever the diagonal cell is free, even between two obstacles
+struct EightConnected {
+    static const int STRAIGHT_COST = 70;
+    static const int DIAGONAL_COST = 99;
+    static const bool CUTS_CORNERS = true; // can step between 4-connected regions
+
+    template <typename GridType>
+    static int expand(const GridType& grid, int index, int neighbors[8], int costs[8]) {
+        int width = grid.getWidth();
+        return expandMask(grid.passableNeighbors8(index % width, index / width), index, width, neighbors, costs);
+    }
+
+    static int expandMask(unsigned passable, int index, int width, int neighbors[8], int costs[8]) {
+        const int offsets[8] = { 1, width, -1, -width, width + 1, width - 1, -width - 1, -width + 1 };
+        int count = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (passable & (1u << i)) {
+                neighbors[count] = index + offsets[i];
+                costs[count++] = i < 4 ? STRAIGHT_COST : DIAGONAL_COST;
+            }
+        }
+        return count;
+    }
+};
+
+// Diagonal moves only when both cells beside the diagonal are free (the Moving AI benchmark rule)
+struct EightConnectedNoCorners {
+    static const int STRAIGHT_COST = EightConnected::STRAIGHT_COST;
+    static const int DIAGONAL_COST = EightConnected::DIAGONAL_COST;
+    static const bool CUTS_CORNERS = false;
+
+    template <typename GridType>
+    static int expand(const GridType& grid, int index, int neighbors[8], int costs[8]) {
+        int width = grid.getWidth();
+        unsigned passable = grid.passableNeighbors8(index % width, index / width);
+        // Keep a diagonal bit only if both straight bits it lies between are set
+        unsigned right = passable & Grid::RIGHT ? 1u : 0u;
+        unsigned down = passable & Grid::DOWN ? 1u : 0u;
+        unsigned left = passable & Grid::LEFT ? 1u : 0u;
+        unsigned up = passable & Grid::UP ? 1u : 0u;
+        unsigned corners = (down & right) * Grid::DOWN_RIGHT | (down & left) * Grid::DOWN_LEFT
+            | (up & left) * Grid::UP_LEFT | (up & right) * Grid::UP_RIGHT;
+        return EightConnected::expandMask(passable & (0x0Fu | corners), index, width, neighbors, costs);
+    }
+};
+
+// Heuristic policies: estimated cost for a |dx|, |dy| offset in the units of a neighbor policy
+struct Manhattan {
+    // Admissible only without diagonal moves
+    template <typename Neighbors>
+    static int estimate(int dx, int dy) { return (dx + dy) * Neighbors::STRAIGHT_COST; }
+};
+
+struct Octile {
+    template <typename Neighbors>
+    static int estimate(int dx, int dy) {
+        int low = dx < dy ? dx : dy;
+        int high = dx < dy ? dy : dx;
+        return low * Neighbors::DIAGONAL_COST + (high - low) * Neighbors::STRAIGHT_COST;
+    }
+};
+
+struct Euclidean {
+    // Rounded down so it stays admissible
+    template <typename Neighbors>
+    static int estimate(int dx, int dy) {
+        return static_cast<int>(std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy) * Neighbors::STRAIGHT_COST);
+    }
+};
+
+// Dijkstra
+struct Zero {
+    template <typename Neighbors>
+    static int estimate(int, int) { return 0; }
+};
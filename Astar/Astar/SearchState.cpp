@@ -0,0 +1,57 @@
+#include "SearchState.h"
+#include <algorithm>
+
+void SearchState::begin(int width, int height) {
+#if ASTAR_STATS
+    stats = SearchStats();
+    stats.queries = 1;
+    currentPhase = SearchStats::SETUP;
+    phaseStart = std::chrono::steady_clock::now();
+#endif
+    size_t cells = static_cast<size_t>(width) * height;
+    if (width != this->width || height != this->height) {
+        this->width = width;
+        this->height = height;
+        costs.assign(cells, 0);
+        parents.assign(cells, -1);
+        stamps.assign(cells, 0);
+        flags.assign(cells, 0);
+        generation = 0;
+    }
+    openList.reset(width * height);
+    expanded = 0;
+    stopped = false;
+
+    // Stamp 0 marks cells no query has touched, so skip it when the counter wraps
+    if (++generation == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+void SearchState::finish() {
+#if ASTAR_STATS
+    // Adds the time spent in the phase still running
+    startPhase(currentPhase);
+    stats.expansions = expanded;
+    SearchStats::addToProcessTotals(stats);
+#endif
+}
+
+void SearchState::setStopCondition(const std::atomic<bool>* cancelled, std::chrono::steady_clock::time_point deadline) {
+    this->cancelled = cancelled;
+    this->deadline = deadline;
+    limited = true;
+}
+
+void SearchState::clearStopCondition() {
+    cancelled = nullptr;
+    limited = false;
+}
+
+bool SearchState::checkStop() {
+    if ((cancelled && cancelled->load(std::memory_order_relaxed)) || std::chrono::steady_clock::now() >= deadline) {
+        stopped = true;
+    }
+    return stopped;
+}
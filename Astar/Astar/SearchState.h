@@ -0,0 +1,162 @@
+#pragma once
+#include "BucketQueue.h"
+#include "IndexedHeap.h"
+#include "SearchStats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#if ASTAR_STATS >= 2
+#include <iostream>
+#endif
+
+// Flat, grid-sized store for the per-cell search data (struct of arrays).
+// Cells are addressed by index (y * width + x). The arrays are kept between
+// queries; instead of clearing them, each query bumps a generation stamp and
+// a cell's g/parent/flags only count when its stamp matches the current one.
+// The open lists live here too so that they keep their capacity between queries:
+// A* uses the bucket queue, searches whose steps can be long (jumps, abstract edges) the heap.
+// Searches report what they do through the record/trace calls, which do nothing
+// unless ASTAR_STATS is enabled (see SearchStats.h).
+class SearchState {
+public:
+    typedef IndexedHeap<4> OpenList;
+    typedef BucketQueue<512> BucketList;
+
+    // Start a new query on a width x height grid. Only allocates when the grid size changes.
+    // With stats enabled this also starts the SETUP phase.
+    void begin(int width, int height);
+    // End the query: close the current phase and add the query to the process totals
+    void finish();
+
+    // Record a (better) route to index and mark it open
+    void open(int index, int g, int parent) {
+        stamps[index] = generation;
+        costs[index] = g;
+        parents[index] = parent;
+        flags[index] = OPEN;
+    }
+    // Mark index as expanded
+    void close(int index) {
+        flags[index] = CLOSED;
+        ++expanded;
+    }
+
+    bool isVisited(int index) const { return stamps[index] == generation; }
+    bool isOpen(int index) const { return isVisited(index) && flags[index] == OPEN; }
+    bool isClosed(int index) const { return isVisited(index) && flags[index] == CLOSED; }
+
+    int getG(int index) const { return costs[index]; }
+    int getParent(int index) const { return parents[index]; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Cells expanded since begin()
+    size_t getExpanded() const { return expanded; }
+    // Reset by begin()
+    OpenList& getOpenList() { return openList; }
+    // Not reset by begin(); call reset() on it before use
+    BucketList& getBucketList() { return bucketList; }
+
+    // Call after the matching open list operation
+    void recordPush(size_t openSize) {
+#if ASTAR_STATS
+        ++stats.pushes;
+        if (openSize > stats.peakOpen) {
+            stats.peakOpen = openSize;
+        }
+#else
+        (void)openSize;
+#endif
+    }
+    void recordDecreaseKey() {
+#if ASTAR_STATS
+        ++stats.decreaseKeys;
+#endif
+    }
+    void recordReopen() {
+#if ASTAR_STATS
+        ++stats.reopenings;
+#endif
+    }
+    void startPhase(SearchStats::Phase phase) {
+#if ASTAR_STATS
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        stats.phaseMicros[currentPhase] += std::chrono::duration<double, std::micro>(now - phaseStart).count();
+        currentPhase = phase;
+        phaseStart = now;
+#else
+        (void)phase;
+#endif
+    }
+    void traceExpand(int index, int f) const {
+#if ASTAR_STATS >= 2
+        std::cout << "Processing node (" << index % width << ", " << index / width << ") with f: " << f << "\n";
+#else
+        (void)index;
+        (void)f;
+#endif
+    }
+    void traceNeighbor(int index, int g, int f) const {
+#if ASTAR_STATS >= 2
+        std::cout << "Considering neighbor (" << index % width << ", " << index / width << ") with g: " << g
+                  << " h: " << f - g << " f: " << f << "\n";
+#else
+        (void)index;
+        (void)g;
+        (void)f;
+#endif
+    }
+    // Optional stop conditions for long searches: a flag another thread may raise and a deadline.
+    // Searches poll them every STOP_CHECK_INTERVAL expansions and give up, returning no path,
+    // once either trips. They stay set across queries until clearStopCondition().
+    void setStopCondition(const std::atomic<bool>* cancelled, std::chrono::steady_clock::time_point deadline);
+    void clearStopCondition();
+    // Called by the searches after each expansion
+    bool shouldStop() {
+        if (!limited || (expanded & (STOP_CHECK_INTERVAL - 1)) != 0) {
+            return false;
+        }
+        return checkStop();
+    }
+    // Whether the last query gave up because of the stop condition
+    bool wasStopped() const { return stopped; }
+    // For searches that run on states of their own (see BidirectionalSearch): hand them this
+    // state's stop condition, then report through wasStopped() whether they gave up
+    void shareStopCondition(SearchState& other) const {
+        other.cancelled = cancelled;
+        other.deadline = deadline;
+        other.limited = limited;
+    }
+    void setStopped(bool stopped) { this->stopped = stopped; }
+    // and add their expansions to this query's
+    void addExpanded(size_t count) { expanded += count; }
+
+    // Stats of the last finished query; all zero unless ASTAR_STATS is enabled
+    const SearchStats& getStats() const { return stats; }
+private:
+    static const std::uint8_t OPEN = 1;
+    static const std::uint8_t CLOSED = 2;
+    static const size_t STOP_CHECK_INTERVAL = 256; // power of two
+
+    bool checkStop();
+
+    int width = 0;
+    int height = 0;
+    std::uint32_t generation = 0;
+    size_t expanded = 0;
+    std::vector<int> costs;
+    std::vector<int> parents;
+    std::vector<std::uint32_t> stamps;
+    std::vector<std::uint8_t> flags;
+    OpenList openList;
+    BucketList bucketList;
+    SearchStats stats;
+    bool limited = false;
+    bool stopped = false;
+    const std::atomic<bool>* cancelled = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+#if ASTAR_STATS
+    SearchStats::Phase currentPhase = SearchStats::SETUP;
+    std::chrono::steady_clock::time_point phaseStart;
+#endif
+};
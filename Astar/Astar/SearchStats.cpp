@@ -0,0 +1,66 @@
+#include "SearchStats.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+    const char* const PHASE_NAMES[SearchStats::PHASES] = { "setup", "search", "path" };
+
+    std::mutex totalsMutex;
+    SearchStats totals;
+}
+
+void SearchStats::add(const SearchStats& other) {
+    queries += other.queries;
+    expansions += other.expansions;
+    pushes += other.pushes;
+    decreaseKeys += other.decreaseKeys;
+    reopenings += other.reopenings;
+    peakOpen = std::max(peakOpen, other.peakOpen);
+    for (int phase = 0; phase < PHASES; ++phase) {
+        phaseMicros[phase] += other.phaseMicros[phase];
+    }
+}
+
+void SearchStats::writeJson(std::ostream& out) const {
+    out << "{\"queries\": " << queries
+        << ", \"expansions\": " << expansions
+        << ", \"pushes\": " << pushes
+        << ", \"decrease_keys\": " << decreaseKeys
+        << ", \"reopenings\": " << reopenings
+        << ", \"peak_open\": " << peakOpen;
+    for (int phase = 0; phase < PHASES; ++phase) {
+        out << ", \"" << PHASE_NAMES[phase] << "_us\": " << phaseMicros[phase];
+    }
+    out << "}";
+}
+
+void SearchStats::writeCsvHeader(std::ostream& out) {
+    out << "queries,expansions,pushes,decrease_keys,reopenings,peak_open";
+    for (int phase = 0; phase < PHASES; ++phase) {
+        out << "," << PHASE_NAMES[phase] << "_us";
+    }
+    out << "\n";
+}
+
+void SearchStats::writeCsvRow(std::ostream& out) const {
+    out << queries << "," << expansions << "," << pushes << "," << decreaseKeys << "," << reopenings << "," << peakOpen;
+    for (int phase = 0; phase < PHASES; ++phase) {
+        out << "," << phaseMicros[phase];
+    }
+    out << "\n";
+}
+
+SearchStats SearchStats::processTotals() {
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    return totals;
+}
+
+void SearchStats::resetProcessTotals() {
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    totals = SearchStats();
+}
+
+void SearchStats::addToProcessTotals(const SearchStats& query) {
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    totals.add(query);
+}
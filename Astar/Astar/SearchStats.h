@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Search instrumentation level, chosen at compile time (e.g. -DASTAR_STATS=1):
+//   0  off; the recording calls in SearchState are empty and compile away
+//   1  per-query counters and phase timings, summed into process totals
+//   2  as 1, plus a trace line on std::cout for every expanded node and considered neighbor
+#ifndef ASTAR_STATS
+#define ASTAR_STATS 0
+#endif
+
+struct SearchStats {
+    enum Phase { SETUP = 0, SEARCH = 1, PATH = 2, PHASES = 3 };
+
+    std::uint64_t queries = 0;
+    std::uint64_t expansions = 0;
+    std::uint64_t pushes = 0;
+    std::uint64_t decreaseKeys = 0;
+    std::uint64_t reopenings = 0;    // closed cells put back on the open list
+    std::uint64_t peakOpen = 0;      // largest open list seen; the maximum over queries in totals
+    double phaseMicros[PHASES] = {}; // steady clock time spent in each phase
+
+    void add(const SearchStats& other);
+    void writeJson(std::ostream& out) const;
+    static void writeCsvHeader(std::ostream& out);
+    void writeCsvRow(std::ostream& out) const;
+
+    // Sum of every finished query in this process (thread-safe)
+    static SearchStats processTotals();
+    static void resetProcessTotals();
+    static void addToProcessTotals(const SearchStats& query);
+};
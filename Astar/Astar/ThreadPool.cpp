@@ -0,0 +1,95 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount) : job(nullptr), batch(0), remaining(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, unsigned)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    // The batch is published and its items queued under one lock, so a worker only starts
+    // on them once job and remaining belong to this call
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &task;
+    remaining = count;
+    ++batch;
+    // Contiguous blocks keep neighboring requests on the same worker until stealing starts
+    size_t workers = queues.size();
+    for (size_t w = 0; w < workers; ++w) {
+        std::lock_guard<std::mutex> queueLock(queues[w]->mutex);
+        for (size_t i = w * count / workers; i < (w + 1) * count / workers; ++i) {
+            queues[w]->items.push_back({ batch, i });
+        }
+    }
+    wake.notify_all();
+    done.wait(lock, [this] { return remaining == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    size_t seen = 0;
+    while (true) {
+        const std::function<void(size_t, unsigned)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = batch;
+            task = job;
+        }
+
+        size_t item;
+        while (take(worker, seen, item)) {
+            (*task)(item, worker);
+            if (--remaining == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+}
+
+bool ThreadPool::take(unsigned worker, size_t batch, size_t& item) {
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty() && own.items.back().batch == batch) {
+            item = own.items.back().index;
+            own.items.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue& victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty() && victim.items.front().batch == batch) {
+            item = victim.items.front().index;
+            victim.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
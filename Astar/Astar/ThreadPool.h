@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task queue each. parallelFor splits the
+// index range evenly over the queues; a worker takes from the back of its own
+// queue and, once that is empty, steals from the front of the others, so uneven
+// tasks (long and short path queries) still keep every core busy.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(threads.size()); }
+
+    // Run task(i, worker) for every i in [0, count) and wait for all of them.
+    // worker is in [0, size()) and no two tasks run on the same worker at once.
+    // Only one thread may call it at a time: a pool runs one batch, and a second caller
+    // would overwrite the job and count of the first.
+    void parallelFor(size_t count, const std::function<void(size_t, unsigned)>& task);
+private:
+    // Index of one task, tagged with the parallelFor call it belongs to
+    struct Item {
+        size_t batch;
+        size_t index;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+
+    void workerLoop(unsigned worker);
+    // Next item of the given batch for a worker, from its own queue first; false when
+    // there is none. A worker still finishing one batch never picks up the next one's items.
+    bool take(unsigned worker, size_t batch, size_t& item);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, unsigned)>* job;
+    size_t batch;
+    std::atomic<size_t> remaining;
+    bool stopping;
+};
@@ -0,0 +1,347 @@
+#include "TiledGrid.h"
+#include "MovingAI.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = { 'T', 'G', 'R', 'D' };
+    const std::uint32_t FORMAT_VERSION = 1;
+
+    // Fields at the start of the header block, all little-endian
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t chunkSize;
+    };
+
+    int shiftOf(int value) {
+        int shift = 0;
+        while ((1 << shift) < value) {
+            ++shift;
+        }
+        return shift;
+    }
+
+    // A 256 x 256 chunk is 8 KiB, so every chunk starts and ends on a page boundary
+    bool validChunkSize(std::uint32_t chunkSize) {
+        return chunkSize >= 256 && chunkSize <= (1u << 16) && (chunkSize & (chunkSize - 1)) == 0;
+    }
+}
+
+TiledGrid::TiledGrid()
+    : width(0), height(0), chunkSize(0), chunkShift(0), wordShift(0), chunksX(0), chunksY(0), chunkBytes(0),
+      maxResident(0), base(nullptr), mappedBytes(0),
+#ifdef _WIN32
+      file(INVALID_HANDLE_VALUE), mapping(nullptr),
+#else
+      file(-1),
+#endif
+      hand(0), loads(0), evictions(0) {}
+
+TiledGrid::~TiledGrid() {
+    close();
+}
+
+bool TiledGrid::convert(const std::string& mapPath, const std::string& tiledPath, int chunkSize) {
+    if (!validChunkSize(static_cast<std::uint32_t>(chunkSize))) {
+        return false;
+    }
+    std::ifstream input(mapPath);
+    int width = 0;
+    int height = 0;
+    if (!input || !MovingAI::readMapHeader(input, width, height)) {
+        return false;
+    }
+    std::ofstream output(tiledPath, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        return false;
+    }
+
+    std::vector<char> header(HEADER_BYTES, 0);
+    Header fields = { { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] }, FORMAT_VERSION,
+                      static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(chunkSize) };
+    std::memcpy(header.data(), &fields, sizeof(fields));
+    output.write(header.data(), header.size());
+
+    // One band of chunkSize rows is converted at a time; its chunks are consecutive in the file
+    int chunksX = (width + chunkSize - 1) / chunkSize;
+    int chunksY = (height + chunkSize - 1) / chunkSize;
+    int wordsPerChunkRow = chunkSize / 64;
+    size_t wordsPerChunk = static_cast<size_t>(chunkSize) * wordsPerChunkRow;
+    std::vector<std::uint64_t> band(wordsPerChunk * chunksX);
+    std::string line;
+    for (int cy = 0; cy < chunksY; ++cy) {
+        // Start with everything blocked so the padding past the edges stays set
+        std::fill(band.begin(), band.end(), ~0ULL);
+        for (int row = 0; row < chunkSize; ++row) {
+            int y = cy * chunkSize + row;
+            if (y >= height) {
+                break;
+            }
+            if (!std::getline(input, line) || static_cast<int>(line.size()) < width) {
+                return false;
+            }
+            for (int x = 0; x < width; ++x) {
+                if (MovingAI::isPassableTerrain(line[x])) {
+                    int cx = x / chunkSize;
+                    int local = x % chunkSize;
+                    band[cx * wordsPerChunk + static_cast<size_t>(row) * wordsPerChunkRow + local / 64] &= ~(1ULL << (local & 63));
+                }
+            }
+        }
+        output.write(reinterpret_cast<const char*>(band.data()), band.size() * sizeof(std::uint64_t));
+    }
+    return static_cast<bool>(output);
+}
+
+bool TiledGrid::open(const std::string& path, size_t maxResidentChunks) {
+    close();
+
+    size_t size = 0;
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(HEADER_BYTES)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        close();
+        return false;
+    }
+#else
+    file = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (file < 0 || fstat(file, &info) != 0 || info.st_size < static_cast<off_t>(HEADER_BYTES)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        close();
+        return false;
+    }
+    // Only read ahead what prefetch asks for, or scattered searches would pull in whole regions
+    madvise(view, size, MADV_RANDOM);
+#endif
+    base = static_cast<const unsigned char*>(view);
+    mappedBytes = size;
+
+    Header fields;
+    std::memcpy(&fields, base, sizeof(fields));
+    if (std::memcmp(fields.magic, MAGIC, sizeof(MAGIC)) != 0 || fields.version != FORMAT_VERSION ||
+        fields.width == 0 || fields.height == 0 || fields.width > 0x7fffffff || fields.height > 0x7fffffff ||
+        !validChunkSize(fields.chunkSize)) {
+        close();
+        return false;
+    }
+    width = static_cast<int>(fields.width);
+    height = static_cast<int>(fields.height);
+    chunkSize = static_cast<int>(fields.chunkSize);
+    chunkShift = shiftOf(chunkSize);
+    wordShift = chunkShift - 6;
+    chunksX = (width + chunkSize - 1) / chunkSize;
+    chunksY = (height + chunkSize - 1) / chunkSize;
+    chunkBytes = static_cast<size_t>(chunkSize) * chunkSize / 8;
+    size_t chunks = static_cast<size_t>(chunksX) * chunksY;
+    if (size != HEADER_BYTES + chunks * chunkBytes) {
+        close();
+        return false;
+    }
+
+    // A corner query touches four chunks and prefetch two more; keep room for them
+    maxResident = std::max<size_t>(maxResidentChunks, 8);
+    slots.assign(chunks, -1);
+    resident.clear();
+    referenced.clear();
+    resident.reserve(std::min(maxResident, chunks));
+    referenced.reserve(std::min(maxResident, chunks));
+    hand = 0;
+    loads = 0;
+    evictions = 0;
+    return true;
+}
+
+void TiledGrid::close() {
+#ifdef _WIN32
+    if (base) {
+        UnmapViewOfFile(base);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (base) {
+        munmap(const_cast<unsigned char*>(base), mappedBytes);
+    }
+    if (file >= 0) {
+        ::close(file);
+        file = -1;
+    }
+#endif
+    base = nullptr;
+    mappedBytes = 0;
+    width = 0;
+    height = 0;
+    slots.clear();
+    resident.clear();
+    referenced.clear();
+}
+
+bool TiledGrid::isObstacle(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        return (word(x >> 6, y) >> (x & 63)) & 1;
+    }
+    return false;
+}
+
+bool TiledGrid::isPassable(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        return !((word(x >> 6, y) >> (x & 63)) & 1);
+    }
+    return false;
+}
+
+unsigned TiledGrid::passableNeighbors4(int x, int y) const {
+    // A search expanding a cell near a chunk edge is likely to cross it soon
+    int localX = x & (chunkSize - 1);
+    int localY = y & (chunkSize - 1);
+    if (localX < PREFETCH_MARGIN) {
+        prefetchChunk((x >> chunkShift) - 1, y >> chunkShift);
+    }
+    else if (localX >= chunkSize - PREFETCH_MARGIN) {
+        prefetchChunk((x >> chunkShift) + 1, y >> chunkShift);
+    }
+    if (localY < PREFETCH_MARGIN) {
+        prefetchChunk(x >> chunkShift, (y >> chunkShift) - 1);
+    }
+    else if (localY >= chunkSize - PREFETCH_MARGIN) {
+        prefetchChunk(x >> chunkShift, (y >> chunkShift) + 1);
+    }
+
+    unsigned above = static_cast<unsigned>(~rowBits(x - 1, y - 1)) & 7;
+    unsigned row = static_cast<unsigned>(~rowBits(x - 1, y)) & 7;
+    unsigned below = static_cast<unsigned>(~rowBits(x - 1, y + 1)) & 7;
+
+    return ((row >> 2) & 1) * Grid::RIGHT
+        | ((below >> 1) & 1) * Grid::DOWN
+        | (row & 1) * Grid::LEFT
+        | ((above >> 1) & 1) * Grid::UP;
+}
+
+unsigned TiledGrid::passableNeighbors8(int x, int y) const {
+    unsigned above = static_cast<unsigned>(~rowBits(x - 1, y - 1)) & 7;
+    unsigned below = static_cast<unsigned>(~rowBits(x - 1, y + 1)) & 7;
+
+    return passableNeighbors4(x, y)
+        | ((below >> 2) & 1) * Grid::DOWN_RIGHT
+        | (below & 1) * Grid::DOWN_LEFT
+        | (above & 1) * Grid::UP_LEFT
+        | ((above >> 2) & 1) * Grid::UP_RIGHT;
+}
+
+std::uint64_t TiledGrid::rowBits(int x, int y) const {
+    if (y < 0 || y >= height || x >= width) {
+        return ~0ULL;
+    }
+    if (x < 0) {
+        if (x <= -64) {
+            return ~0ULL;
+        }
+        return (rowBits(0, y) << -x) | ((1ULL << -x) - 1);
+    }
+    // Stored rows run to the end of the last chunk, and the padding there is set
+    int wx = x >> 6;
+    int offset = x & 63;
+    std::uint64_t bits = word(wx, y) >> offset;
+    if (offset != 0) {
+        std::uint64_t next = (wx + 1) < (chunksX << wordShift) ? word(wx + 1, y) : ~0ULL;
+        bits |= next << (64 - offset);
+    }
+    return bits;
+}
+
+void TiledGrid::prefetch(int x, int y) const {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        prefetchChunk(x >> chunkShift, y >> chunkShift);
+    }
+}
+
+void TiledGrid::prefetchChunk(int cx, int cy) const {
+    if (cx >= 0 && cx < chunksX && cy >= 0 && cy < chunksY) {
+        int chunk = cy * chunksX + cx;
+        if (slots[chunk] < 0) {
+            load(chunk);
+        }
+    }
+}
+
+int TiledGrid::load(int chunk) const {
+    int slot;
+    if (resident.size() < maxResident) {
+        slot = static_cast<int>(resident.size());
+        resident.push_back(chunk);
+        referenced.push_back(0);
+    }
+    else {
+        // Clock sweep: chunks used since the hand last passed get a second chance
+        while (referenced[hand]) {
+            referenced[hand] = 0;
+            hand = (hand + 1) % resident.size();
+        }
+        int victim = resident[hand];
+        adviseDontNeed(victim);
+        slots[victim] = -1;
+        ++evictions;
+        resident[hand] = chunk;
+        slot = static_cast<int>(hand);
+        hand = (hand + 1) % resident.size();
+    }
+    slots[chunk] = slot;
+    ++loads;
+    adviseWillNeed(chunk);
+    return slot;
+}
+
+void TiledGrid::adviseWillNeed(int chunk) const {
+    const unsigned char* start = base + HEADER_BYTES + static_cast<size_t>(chunk) * chunkBytes;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = { const_cast<unsigned char*>(start), chunkBytes };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(const_cast<unsigned char*>(start), chunkBytes, MADV_WILLNEED);
+#endif
+}
+
+void TiledGrid::adviseDontNeed(int chunk) const {
+    // The mapping is read-only, so dropped pages are simply read from the file again if needed
+    const unsigned char* start = base + HEADER_BYTES + static_cast<size_t>(chunk) * chunkBytes;
+#ifdef _WIN32
+    // Unlocking pages that are not locked removes them from the working set
+    VirtualUnlock(const_cast<unsigned char*>(start), chunkBytes);
+#else
+    madvise(const_cast<unsigned char*>(start), chunkBytes, MADV_DONTNEED);
+#endif
+}
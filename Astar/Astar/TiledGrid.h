@@ -0,0 +1,102 @@
+#pragma once
+#include "Grid.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only obstacle map stored on disk as square chunks of bit-packed cells and
+// memory-mapped, for maps too large to load. Opening only maps the file, so it takes
+// the same time for any size; chunks are paged in by the OS on first use.
+// The object keeps at most maxResidentChunks chunks counted as resident. Past that it
+// picks a victim with a clock sweep and tells the OS to drop its pages, so memory stays
+// bounded however far a search wanders. Neighbor queries within PREFETCH_MARGIN cells of
+// a chunk edge ask the OS to start reading the chunk across that edge, so chunks along
+// the search frontier are usually in memory by the time the search gets there.
+// The query interface matches Grid's, so Pathfinding::findPath<Neighbors, Heuristic>
+// runs on it directly. Cell indices are ints, so searches need width * height < 2^31.
+// Not thread-safe: the residency bookkeeping changes on every query.
+//
+// File layout (little-endian): a HEADER_BYTES header, then the chunks in row-major chunk
+// order, each chunkSize rows of chunkSize / 64 words with bit x of a word set for an
+// obstacle. Cells past the right and bottom edges are stored as obstacles.
+class TiledGrid {
+public:
+    static const int DEFAULT_CHUNK_SIZE = 256; // 8 KiB chunks
+    static const int PREFETCH_MARGIN = 8;
+
+    TiledGrid();
+    ~TiledGrid();
+    TiledGrid(const TiledGrid&) = delete;
+    TiledGrid& operator=(const TiledGrid&) = delete;
+
+    // Convert a Moving AI .map file (or any text grid with the same header) one band of
+    // chunk rows at a time; chunkSize must be a power of two and at least 256
+    static bool convert(const std::string& mapPath, const std::string& tiledPath, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+    bool open(const std::string& path, size_t maxResidentChunks = 4096);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    bool isObstacle(int x, int y) const;
+    bool isPassable(int x, int y) const;
+    unsigned passableNeighbors4(int x, int y) const;
+    unsigned passableNeighbors8(int x, int y) const;
+    // Obstacle bits of cells x..x+63 in row y (bit 0 = cell x); cells outside the grid read as obstacles
+    std::uint64_t rowBits(int x, int y) const;
+    // No region labels are stored, so this only checks that both cells are free
+    bool isReachable(int x0, int y0, int x1, int y1) const { return isPassable(x0, y0) && isPassable(x1, y1); }
+    // Start reading the chunk holding (x, y) in the background
+    void prefetch(int x, int y) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChunkSize() const { return chunkSize; }
+    size_t getResidentChunks() const { return resident.size(); }
+    // Chunks brought in (on demand or by prefetch) and dropped since open()
+    size_t getChunkLoads() const { return loads; }
+    size_t getChunkEvictions() const { return evictions; }
+private:
+    static const size_t HEADER_BYTES = 4096;
+
+    // Word wx (cells wx * 64 .. wx * 64 + 63) of row y, which must be inside the stored area
+    std::uint64_t word(int wx, int y) const {
+        int chunk = (y >> chunkShift) * chunksX + (wx >> wordShift);
+        int slot = slots[chunk];
+        if (slot < 0) {
+            slot = load(chunk);
+        }
+        referenced[slot] = 1;
+        const std::uint64_t* data = reinterpret_cast<const std::uint64_t*>(base + HEADER_BYTES + static_cast<size_t>(chunk) * chunkBytes);
+        return data[((y & (chunkSize - 1)) << wordShift) + (wx & ((1 << wordShift) - 1))];
+    }
+    // Count chunk as resident, evicting another if the budget is full; returns its slot
+    int load(int chunk) const;
+    void prefetchChunk(int cx, int cy) const;
+    void adviseWillNeed(int chunk) const;
+    void adviseDontNeed(int chunk) const;
+
+    int width;
+    int height;
+    int chunkSize;
+    int chunkShift; // log2(chunkSize)
+    int wordShift;  // log2(words per chunk row)
+    int chunksX;
+    int chunksY;
+    size_t chunkBytes;
+    size_t maxResident;
+    const unsigned char* base;
+    size_t mappedBytes;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int file;
+#endif
+    mutable std::vector<int> slots;              // per chunk: slot in resident, or -1
+    mutable std::vector<int> resident;           // per slot: chunk
+    mutable std::vector<unsigned char> referenced; // per slot: clock bit
+    mutable size_t hand;
+    mutable size_t loads;
+    mutable size_t evictions;
+};
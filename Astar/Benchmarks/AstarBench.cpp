@@ -0,0 +1,520 @@
+// Headless benchmark harness: runs every query of a Moving AI scenario file on its map
+// and reports latency percentiles, expanded nodes and whether each path is optimal.
+// No SDL dependency; see AstarBench.vcxproj, or build from this directory with
+//   g++ -O2 -std=c++17 -pthread -I../Astar AstarBench.cpp ../Astar/AnytimeSearch.cpp ../Astar/Grid.cpp ../Astar/ComponentIndex.cpp
+//       ../Astar/SearchState.cpp ../Astar/SearchStats.cpp
+//       ../Astar/Pathfinding.cpp ../Astar/JumpTable.cpp ../Astar/JumpPointSearch.cpp ../Astar/BidirectionalSearch.cpp
+//       ../Astar/Landmarks.cpp ../Astar/Hierarchy.cpp ../Astar/ThreadPool.cpp ../Astar/BatchPathfinder.cpp
+//       ../Astar/MovingAI.cpp -o AstarBench
+// Add -DASTAR_STATS=1 for the search counters and phase timings (see SearchStats.h).
+//
+// Usage: AstarBench <file.map> <file.scen> [--mode astar|jps|jps+|bidir|alt|anytime|hpa] [--neighbors 4|8|8nc]
+//                   [--heuristic manhattan|octile|euclidean|zero] [--repeat N] [--csv] [--stats json|csv]
+//                   [--landmarks K] [--landmark-file F] [--weight W] [--tick N] [--cluster C] [--sweep]
+//
+// --mode alt is 4-connected A* with the landmark heuristic (see Landmarks.h), using K
+// landmarks (default 16). With --landmark-file the tables are loaded from F, or built and
+// saved there when F is missing or was made for another map.
+// --mode anytime runs ARA* (see AnytimeSearch.h) from weight W (default 3) in ticks of N
+// expansions (default 100) until the path is optimal, and also reports when the first
+// path arrived and its bound.
+// --mode hpa runs HPA* (see Hierarchy.h) on clusters of C x C cells (default 16). Its
+// paths are near-optimal, so longer ones are reported as suboptimal, not as mismatches.
+// --sweep then runs the whole scenario file as one batch through BatchPathfinder with 1, 2,
+// 4 and 8 workers (astar, jps and jps+ only) and reports the wall time of each and its
+// speed-up over one worker. Scaling stops at the number of hardware threads, also printed.
+//
+// Each path cost is checked against a Dijkstra reference using the same neighbor policy.
+// Scenario optima are octile lengths without corner cutting, so with --neighbors 8nc the
+// path is also checked against them (to within the 99/70 approximation of sqrt(2)).
+#include "AnytimeSearch.h"
+#include "BatchPathfinder.h"
+#include "BidirectionalSearch.h"
+#include "Grid.h"
+#include "Hierarchy.h"
+#include "JumpTable.h"
+#include "Landmarks.h"
+#include "MovingAI.h"
+#include "Pathfinding.h"
+#include "SearchState.h"
+#include "SearchStats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Result {
+        double micros;
+        size_t expanded;
+        int length;    // path cost in policy units, -1 when no path was found
+        int reference; // policy units, -1 when unreachable
+        bool valid;
+    };
+
+    typedef std::vector<Node> (*Search)(const Grid&, const Node&, const Node&, SearchState&);
+    typedef std::vector<Node> (*BidirectionalRun)(BidirectionalSearch&, const Grid&, const Node&, const Node&);
+
+    template <typename Neighbors, typename Heuristic>
+    std::vector<Node> runBidirectional(BidirectionalSearch& search, const Grid& grid, const Node& start, const Node& end) {
+        return search.findPath<Neighbors, Heuristic>(grid, start, end);
+    }
+
+    // Shortest path cost by Dijkstra with a binary heap, -1 when unreachable
+    template <typename Neighbors>
+    int referenceCost(const Grid& grid, const Scenario& s, std::vector<int>& distance) {
+        typedef std::pair<int, int> Entry; // (distance, index)
+        int width = grid.getWidth();
+        if (!grid.isPassable(s.startX, s.startY) || !grid.isPassable(s.goalX, s.goalY)) {
+            return -1;
+        }
+        std::fill(distance.begin(), distance.end(), -1);
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        int start = s.startY * width + s.startX;
+        int goal = s.goalY * width + s.goalX;
+        distance[start] = 0;
+        queue.push(Entry(0, start));
+        while (!queue.empty()) {
+            Entry current = queue.top();
+            queue.pop();
+            if (current.first != distance[current.second]) {
+                continue;
+            }
+            if (current.second == goal) {
+                return current.first;
+            }
+            int neighbors[8];
+            int costs[8];
+            int count = Neighbors::expand(grid, current.second, neighbors, costs);
+            for (int i = 0; i < count; ++i) {
+                int next = current.first + costs[i];
+                if (distance[neighbors[i]] < 0 || next < distance[neighbors[i]]) {
+                    distance[neighbors[i]] = next;
+                    queue.push(Entry(next, neighbors[i]));
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Cost of a path whose steps are all moves the neighbor policy allows, -1 for an invalid path
+    template <typename Neighbors>
+    int pathCost(const Grid& grid, const Scenario& s, const std::vector<Node>& path) {
+        if (path.empty()) {
+            return -1;
+        }
+        if (path.front().x != s.startX || path.front().y != s.startY || path.back().x != s.goalX || path.back().y != s.goalY) {
+            return -1;
+        }
+        int width = grid.getWidth();
+        int cost = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            int neighbors[8];
+            int costs[8];
+            int count = Neighbors::expand(grid, path[i - 1].y * width + path[i - 1].x, neighbors, costs);
+            int index = path[i].y * width + path[i].x;
+            int step = -1;
+            for (int j = 0; j < count; ++j) {
+                if (neighbors[j] == index) {
+                    step = costs[j];
+                }
+            }
+            if (step < 0) {
+                return -1;
+            }
+            cost += step;
+        }
+        return cost;
+    }
+
+    // Euclidean length of a path, for comparison with the scenario optimum
+    double pathLength(const std::vector<Node>& path) {
+        double length = 0.0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            bool diagonal = path[i].x != path[i - 1].x && path[i].y != path[i - 1].y;
+            length += diagonal ? std::sqrt(2.0) : 1.0;
+        }
+        return length;
+    }
+
+    template <typename Neighbors, typename Heuristic>
+    void select(Search& search, BidirectionalRun& bidirectional) {
+        search = &Pathfinding::findPath<Neighbors, Heuristic>;
+        bidirectional = &runBidirectional<Neighbors, Heuristic>;
+    }
+
+    template <typename Neighbors>
+    bool selectSearch(const std::string& heuristic, Search& search, BidirectionalRun& bidirectional) {
+        if (heuristic == "manhattan") select<Neighbors, Manhattan>(search, bidirectional);
+        else if (heuristic == "octile") select<Neighbors, Octile>(search, bidirectional);
+        else if (heuristic == "euclidean") select<Neighbors, Euclidean>(search, bidirectional);
+        else if (heuristic == "zero") select<Neighbors, Zero>(search, bidirectional);
+        else return false;
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[rank];
+    }
+
+    int usage() {
+        std::cerr << "Usage: AstarBench <file.map> <file.scen> [--mode astar|jps|jps+|bidir|alt|anytime|hpa] [--neighbors 4|8|8nc]\n"
+                  << "                  [--heuristic manhattan|octile|euclidean|zero] [--repeat N] [--csv] [--stats json|csv]\n"
+                  << "                  [--landmarks K] [--landmark-file F] [--weight W] [--tick N] [--cluster C] [--sweep]" << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        return usage();
+    }
+    std::string mapPath = argv[1];
+    std::string scenarioPath = argv[2];
+    SearchMode mode = SearchMode::AStar;
+    std::string modeName = "astar";
+    std::string neighborsName = "4";
+    std::string heuristicName;
+    int repeat = 1;
+    bool csv = false;
+    std::string statsFormat;
+    bool landmarkMode = false;
+    int landmarkCount = Landmarks::MAX_LANDMARKS;
+    std::string landmarkPath;
+    bool anytimeMode = false;
+    double weight = 3.0;
+    size_t tick = 100;
+    bool hierarchyMode = false;
+    int clusterSize = 16;
+    bool sweep = false;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            modeName = argv[++i];
+            if (modeName == "astar") mode = SearchMode::AStar;
+            else if (modeName == "jps") mode = SearchMode::JumpPoint;
+            else if (modeName == "jps+") mode = SearchMode::JumpPointPlus;
+            else if (modeName == "bidir") mode = SearchMode::Bidirectional;
+            else if (modeName == "alt" || modeName == "anytime" || modeName == "hpa") mode = SearchMode::AStar;
+            else return usage();
+            landmarkMode = modeName == "alt";
+            anytimeMode = modeName == "anytime";
+            hierarchyMode = modeName == "hpa";
+        }
+        else if (std::strcmp(argv[i], "--neighbors") == 0 && i + 1 < argc) {
+            neighborsName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--heuristic") == 0 && i + 1 < argc) {
+            heuristicName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--landmarks") == 0 && i + 1 < argc) {
+            landmarkCount = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--landmark-file") == 0 && i + 1 < argc) {
+            landmarkPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            weight = std::max(1.0, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--tick") == 0 && i + 1 < argc) {
+            tick = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (std::strcmp(argv[i], "--cluster") == 0 && i + 1 < argc) {
+            clusterSize = std::max(2, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--sweep") == 0) {
+            sweep = true;
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsFormat = argv[++i];
+            if (statsFormat != "json" && statsFormat != "csv") return usage();
+        }
+        else {
+            return usage();
+        }
+    }
+
+    if (heuristicName.empty()) {
+        heuristicName = neighborsName == "4" ? "manhattan" : "octile";
+    }
+    // The policy-specialised search is picked once here, not per expansion
+    Search search = nullptr;
+    BidirectionalRun bidirectional = nullptr;
+    bool known = false;
+    int (*reference)(const Grid&, const Scenario&, std::vector<int>&) = nullptr;
+    int (*cost)(const Grid&, const Scenario&, const std::vector<Node>&) = nullptr;
+    if (neighborsName == "4") {
+        known = selectSearch<FourConnected>(heuristicName, search, bidirectional);
+        reference = &referenceCost<FourConnected>;
+        cost = &pathCost<FourConnected>;
+    }
+    else if (neighborsName == "8") {
+        known = selectSearch<EightConnected>(heuristicName, search, bidirectional);
+        reference = &referenceCost<EightConnected>;
+        cost = &pathCost<EightConnected>;
+    }
+    else if (neighborsName == "8nc") {
+        known = selectSearch<EightConnectedNoCorners>(heuristicName, search, bidirectional);
+        reference = &referenceCost<EightConnectedNoCorners>;
+        cost = &pathCost<EightConnectedNoCorners>;
+    }
+    bool jumpPoint = mode == SearchMode::JumpPoint || mode == SearchMode::JumpPointPlus;
+    if (!known || ((jumpPoint || landmarkMode || anytimeMode || hierarchyMode) && neighborsName != "4")) {
+        // Jump point search, the landmark tables, the anytime search and HPA* are 4-connected only
+        return usage();
+    }
+    if (sweep && (mode == SearchMode::Bidirectional || landmarkMode || anytimeMode || hierarchyMode || neighborsName != "4")) {
+        // BatchPathfinder runs Pathfinding::findPath, which is 4-connected; bidirectional
+        // searches already use two threads each
+        return usage();
+    }
+    bool checkScenario = neighborsName == "8nc";
+
+    Grid grid(1, 1);
+    if (!MovingAI::loadMap(mapPath, grid)) {
+        std::cerr << "Could not load map " << mapPath << std::endl;
+        return 1;
+    }
+    std::vector<Scenario> scenarios;
+    if (!MovingAI::loadScenarios(scenarioPath, scenarios)) {
+        std::cerr << "Could not load scenarios " << scenarioPath << std::endl;
+        return 1;
+    }
+
+    JumpTable table;
+    if (mode == SearchMode::JumpPointPlus) {
+        auto begin = std::chrono::steady_clock::now();
+        table.build(grid);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "Jump table built in " << ms << " ms" << std::endl;
+    }
+
+    Landmarks landmarks(grid);
+    if (landmarkMode) {
+        if (!landmarkPath.empty() && landmarks.load(landmarkPath)) {
+            std::cout << "Landmarks loaded from " << landmarkPath << std::endl;
+        }
+        else {
+            auto begin = std::chrono::steady_clock::now();
+            if (!landmarks.build(landmarkCount)) {
+                std::cerr << "Could not place landmarks on " << mapPath << std::endl;
+                return 1;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            std::cout << landmarks.getCount() << " landmarks built in " << ms << " ms" << std::endl;
+            if (!landmarkPath.empty() && !landmarks.save(landmarkPath)) {
+                std::cerr << "Could not save landmarks to " << landmarkPath << std::endl;
+            }
+        }
+    }
+
+    // Built up front, as the cluster distances are what HPA* trades for its speed
+    std::unique_ptr<Hierarchy> hierarchy;
+    if (hierarchyMode) {
+        auto begin = std::chrono::steady_clock::now();
+        hierarchy.reset(new Hierarchy(grid, clusterSize));
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "Hierarchy of " << hierarchy->getNodeCount() << " abstract nodes built in " << ms << " ms" << std::endl;
+    }
+
+    SearchState state;
+    BidirectionalSearch bidirectionalSearch;
+    AnytimeSearch anytime(grid);
+    std::vector<double> firstMicros; // anytime mode: when the first path arrived
+    double firstBound = 0.0;         // and the sums of its bound and its cost over the optimum
+    double firstRatio = 0.0;
+    std::vector<int> distance(static_cast<size_t>(grid.getWidth()) * grid.getHeight());
+    std::vector<Result> results;
+    if (csv) {
+        std::cout << "query,bucket,latency_us,expanded,cost,reference,match" << std::endl;
+    }
+    for (size_t q = 0; q < scenarios.size(); ++q) {
+        const Scenario& s = scenarios[q];
+        Node start(s.startX, s.startY);
+        Node goal(s.goalX, s.goalY);
+
+        std::vector<Node> path;
+        double best = 0.0;
+        int firstCost = -1;
+        for (int r = 0; r < repeat; ++r) {
+            auto begin = std::chrono::steady_clock::now();
+            if (landmarkMode) {
+                path = landmarks.findPath(start, goal, state);
+            }
+            else if (anytimeMode) {
+                anytime.plan(start, goal, weight);
+                bool first = r == 0;
+                while (!anytime.isFinished()) {
+                    anytime.improve(std::chrono::microseconds(0), tick);
+                    if (first && !anytime.getPath().empty()) {
+                        first = false;
+                        firstMicros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+                        firstBound += anytime.getBound();
+                        firstCost = anytime.getPath().back().g;
+                    }
+                }
+                path = anytime.getPath();
+            }
+            else if (hierarchyMode) {
+                path = hierarchy->findPath(start, goal);
+            }
+            else if (mode == SearchMode::AStar) {
+                path = search(grid, start, goal, state);
+            }
+            else if (mode == SearchMode::Bidirectional) {
+                path = bidirectional(bidirectionalSearch, grid, start, goal);
+            }
+            else {
+                path = Pathfinding::findPath(grid, start, goal, state, mode, &table);
+            }
+            double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            best = r == 0 ? micros : std::min(best, micros);
+        }
+
+        Result result;
+        result.micros = best;
+        result.expanded = mode == SearchMode::Bidirectional ? bidirectionalSearch.getExpanded()
+                        : anytimeMode ? anytime.getTotalExpanded()
+                        : hierarchyMode ? hierarchy->getExpanded() : state.getExpanded();
+        result.length = cost(grid, s, path);
+        result.reference = reference(grid, s, distance);
+        result.valid = path.empty() || result.length >= 0;
+        if (checkScenario && result.length >= 0 && std::fabs(pathLength(path) - s.optimalLength) > 1e-4 * s.optimalLength + 1e-3) {
+            result.valid = false;
+        }
+        if (firstCost > 0 && result.reference > 0) {
+            firstRatio += static_cast<double>(firstCost) / result.reference;
+        }
+        results.push_back(result);
+        if (csv) {
+            std::cout << q << "," << s.bucket << "," << result.micros << "," << result.expanded << ","
+                      << result.length << "," << result.reference << ","
+                      << (result.valid && result.length == result.reference ? 1 : 0) << std::endl;
+        }
+    }
+
+    std::vector<double> latencies;
+    size_t expanded = 0;
+    size_t solved = 0;
+    size_t mismatches = 0;
+    size_t suboptimal = 0;  // hpa mode: valid paths longer than the reference
+    double costRatio = 0.0; // and the sum of their cost over the optimum
+    for (const Result& result : results) {
+        latencies.push_back(result.micros);
+        expanded += result.expanded;
+        if (result.length >= 0) {
+            ++solved;
+        }
+        if (hierarchyMode && result.valid && result.length > result.reference && result.reference >= 0) {
+            ++suboptimal;
+            costRatio += static_cast<double>(result.length) / result.reference;
+        }
+        else if (!result.valid || result.length != result.reference) {
+            ++mismatches;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for (double micros : latencies) {
+        total += micros;
+    }
+
+    std::cout << "map " << mapPath << " (" << grid.getWidth() << "x" << grid.getHeight() << "), mode " << modeName;
+    if (landmarkMode) {
+        std::cout << ", landmarks " << landmarks.getCount();
+    }
+    else if (hierarchyMode) {
+        std::cout << ", clusters " << clusterSize << "x" << clusterSize;
+    }
+    else if (!jumpPoint) {
+        std::cout << ", neighbors " << neighborsName << ", heuristic " << heuristicName;
+    }
+    std::cout << std::endl;
+    std::cout << "queries " << results.size() << ", solved " << solved << ", mismatches " << mismatches << std::endl;
+    if (hierarchyMode) {
+        std::cout << "suboptimal " << suboptimal << ", their mean cost over optimum "
+                  << (suboptimal == 0 ? 1.0 : costRatio / suboptimal) << std::endl;
+    }
+    std::cout << "latency us: mean " << (results.empty() ? 0.0 : total / results.size())
+              << ", p50 " << percentile(latencies, 50) << ", p90 " << percentile(latencies, 90)
+              << ", p99 " << percentile(latencies, 99) << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << std::endl;
+    std::cout << "expanded: total " << expanded << ", mean " << (results.empty() ? 0 : expanded / results.size()) << std::endl;
+    if (anytimeMode && !firstMicros.empty()) {
+        double firstTotal = 0.0;
+        for (double micros : firstMicros) {
+            firstTotal += micros;
+        }
+        size_t n = firstMicros.size();
+        std::sort(firstMicros.begin(), firstMicros.end());
+        std::cout << "first path us: mean " << firstTotal / n << ", p50 " << percentile(firstMicros, 50)
+                  << ", p99 " << percentile(firstMicros, 99) << "; mean bound " << firstBound / n
+                  << ", mean cost over optimum " << firstRatio / n << std::endl;
+    }
+    if (!statsFormat.empty()) {
+        // Every search run, repeats included; all zero unless built with ASTAR_STATS
+        SearchStats totals = SearchStats::processTotals();
+        if (statsFormat == "json") {
+            totals.writeJson(std::cout);
+            std::cout << std::endl;
+        }
+        else {
+            SearchStats::writeCsvHeader(std::cout);
+            totals.writeCsvRow(std::cout);
+        }
+    }
+
+    if (sweep) {
+        std::vector<PathRequest> requests;
+        for (const Scenario& s : scenarios) {
+            requests.push_back(PathRequest{ Node(s.startX, s.startY), Node(s.goalX, s.goalY) });
+        }
+        std::cout << "thread sweep, " << requests.size() << " queries per batch, "
+                  << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+        const unsigned threadCounts[] = { 1, 2, 4, 8 };
+        double single = 0.0;
+        for (unsigned threads : threadCounts) {
+            BatchPathfinder batch(threads);
+            // One untimed batch first, so every worker's search state has grown to the grid
+            std::vector<std::vector<Node>> paths = batch.findPaths(grid, requests, mode, &table);
+            double best = 0.0;
+            for (int r = 0; r < repeat; ++r) {
+                auto begin = std::chrono::steady_clock::now();
+                paths = batch.findPaths(grid, requests, mode, &table);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                best = r == 0 ? ms : std::min(best, ms);
+            }
+            // The same costs as the single query runs above
+            size_t different = 0;
+            for (size_t q = 0; q < paths.size(); ++q) {
+                if (cost(grid, scenarios[q], paths[q]) != results[q].length) {
+                    ++different;
+                }
+            }
+            if (threads == 1) {
+                single = best;
+            }
+            std::cout << threads << " workers: " << best << " ms, "
+                      << (best > 0.0 ? requests.size() * 1000.0 / best : 0.0) << " queries/s, speed-up "
+                      << (best > 0.0 ? single / best : 0.0) << ", mismatches " << different << std::endl;
+            mismatches += different;
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
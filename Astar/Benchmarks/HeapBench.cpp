@@ -0,0 +1,194 @@
+// Open list microbenchmark: runs the same A* over large open grids with each open list
+// implementation and reports time per search.
+//
+// Build from this directory:
+//   g++ -O2 -std=c++17 -I../Astar HeapBench.cpp ../Astar/Grid.cpp ../Astar/ComponentIndex.cpp ../Astar/SearchState.cpp -o HeapBench
+//   cl /O2 /std:c++17 /EHsc /I..\Astar HeapBench.cpp ..\Astar\Grid.cpp ..\Astar\ComponentIndex.cpp ..\Astar\SearchState.cpp
+#include "BucketQueue.h"
+#include "Grid.h"
+#include "IndexedHeap.h"
+#include "SearchState.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+// The queue used before the indexed heap: a priority_queue of pointers shadowed by a
+// vector that is searched on every neighbor and erased from on every pop
+class LegacyQueue {
+public:
+    void reset(int) {
+        queue = Queue();
+        container.clear();
+    }
+    bool empty() const { return queue.empty(); }
+    void push(int index, int f, int g) {
+        if (!contains(index)) {
+            container.push_back({ f, g, index });
+        }
+        queue.push({ f, g, index });
+    }
+    void decreaseKey(int index, int f, int g) {
+        push(index, f, g); // the old queue could not update in place either
+    }
+    OpenEntry pop() {
+        OpenEntry top = queue.top();
+        queue.pop();
+        container.erase(std::remove_if(container.begin(), container.end(), [&](const OpenEntry& e) { return e.index == top.index; }), container.end());
+        return top;
+    }
+private:
+    bool contains(int index) const {
+        return std::find_if(container.begin(), container.end(), [&](const OpenEntry& e) { return e.index == index; }) != container.end();
+    }
+
+    struct Compare {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const { return a.f > b.f; }
+    };
+    typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, Compare> Queue;
+    Queue queue;
+    std::vector<OpenEntry> container;
+};
+
+// priority_queue with duplicate entries instead of decrease-key; stale entries are skipped on pop
+class LazyQueue {
+public:
+    void reset(int) { queue = Queue(); }
+    bool empty() const { return queue.empty(); }
+    void push(int index, int f, int g) { queue.push({ f, g, index }); }
+    void decreaseKey(int index, int f, int g) { queue.push({ f, g, index }); }
+    OpenEntry pop() {
+        OpenEntry top = queue.top();
+        queue.pop();
+        return top;
+    }
+private:
+    struct Compare {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            return a.f > b.f || (a.f == b.f && a.g < b.g);
+        }
+    };
+    typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, Compare> Queue;
+    Queue queue;
+};
+
+// A* with Manhattan heuristic; only the open list differs between runs. Returns the path cost.
+template <typename Queue>
+int search(const Grid& grid, int start, int goal, SearchState& state, Queue& open, int& expanded) {
+    int width = grid.getWidth();
+    int gx = goal % width;
+    int gy = goal / width;
+    state.begin(width, grid.getHeight());
+    open.reset(width * grid.getHeight());
+    state.open(start, 0, -1);
+    open.push(start, std::abs(start % width - gx) + std::abs(start / width - gy), 0);
+    expanded = 0;
+
+    while (!open.empty()) {
+        OpenEntry current = open.pop();
+        if (state.isClosed(current.index)) {
+            continue;
+        }
+        state.close(current.index);
+        ++expanded;
+        if (current.index == goal) {
+            return current.g;
+        }
+
+        int x = current.index % width;
+        int y = current.index / width;
+        int dirs[4][2] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
+        for (auto& dir : dirs) {
+            int nx = x + dir[0];
+            int ny = y + dir[1];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= grid.getHeight() || grid.isObstacle(nx, ny)) {
+                continue;
+            }
+            int neighbor = ny * width + nx;
+            if (state.isClosed(neighbor)) {
+                continue;
+            }
+            int g = current.g + 1;
+            int f = g + std::abs(nx - gx) + std::abs(ny - gy);
+            if (!state.isOpen(neighbor)) {
+                state.open(neighbor, g, current.index);
+                open.push(neighbor, f, g);
+            }
+            else if (g < state.getG(neighbor)) {
+                state.open(neighbor, g, current.index);
+                open.decreaseKey(neighbor, f, g);
+            }
+        }
+    }
+    return -1;
+}
+
+template <typename Queue>
+void run(const char* name, const Grid& grid, int start, int goal, int repeats) {
+    SearchState state;
+    Queue open;
+    int expanded = 0;
+    int cost = search(grid, start, goal, state, open, expanded); // warm-up, also sizes the buffers
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        search(grid, start, goal, state, open, expanded);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / repeats;
+    std::cout << "  " << name << ": " << ms << " ms/search, cost " << cost << ", expanded " << expanded << std::endl;
+}
+
+// Open grid with a wall across most of the middle, so the search floods a large area
+// and the open list grows with the grid side
+Grid makeGrid(int size, double scatter, unsigned seed) {
+    Grid grid(size, size);
+    for (int x = 0; x < size - 2; ++x) {
+        grid.setObstacle(x, size / 2);
+    }
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (coin(rng) < scatter) {
+                grid.setObstacle(x, y);
+            }
+        }
+    }
+    // Keep the endpoints and the gap in the wall open
+    for (int i = 0; i < 2; ++i) {
+        grid.clearObstacle(i, 0);
+        grid.clearObstacle(0, i);
+        grid.clearObstacle(i, size - 1);
+        grid.clearObstacle(0, size - 1 - i);
+    }
+    for (int y = size / 2 - 1; y <= size / 2 + 1; ++y) {
+        grid.clearObstacle(size - 2, y);
+        grid.clearObstacle(size - 1, y);
+    }
+    return grid;
+}
+
+int main() {
+    const int sizes[] = { 128, 256, 1024, 2048 };
+    for (int size : sizes) {
+        for (double scatter : { 0.0, 0.2 }) {
+            Grid grid = makeGrid(size, scatter, 42);
+            int start = 0;
+            int goal = (size - 1) * size;
+            int repeats = size <= 256 ? 10 : 3;
+            std::cout << size << "x" << size << " grid, " << scatter * 100 << "% scattered obstacles" << std::endl;
+            if (size <= 256) {
+                run<LegacyQueue>("priority_queue + linear container", grid, start, goal, repeats);
+            }
+            run<LazyQueue>("priority_queue, lazy deletion", grid, start, goal, repeats);
+            run<IndexedHeap<2>>("indexed binary heap", grid, start, goal, repeats);
+            run<IndexedHeap<4>>("indexed 4-ary heap", grid, start, goal, repeats);
+            run<IndexedHeap<8>>("indexed 8-ary heap", grid, start, goal, repeats);
+            run<BucketQueue<512>>("bucket queue", grid, start, goal, repeats);
+        }
+    }
+    return 0;
+}
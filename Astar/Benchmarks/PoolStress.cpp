@@ -0,0 +1,53 @@
+// ThreadPool stress test: runs many short parallelFor batches back to back, each with
+// its own task object, and checks that every index ran exactly once in its own batch:
+// the caller moves a shared batch id on once parallelFor returns, so a task that runs
+// late, or for the wrong batch, sees an id other than the one it was made for.
+// Returns non-zero on a mismatch. Worth running under ThreadSanitizer as well.
+//
+// Build from this directory:
+//   g++ -O2 -std=c++17 -pthread -I../Astar PoolStress.cpp ../Astar/ThreadPool.cpp -o PoolStress
+//   cl /O2 /std:c++17 /EHsc /I..\Astar PoolStress.cpp ..\Astar\ThreadPool.cpp
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const unsigned threadCounts[] = { 1, 2, 4, 8 };
+    size_t failures = 0;
+    std::atomic<size_t> lateTasks(0);
+    std::atomic<int> batch(-1);
+    for (unsigned threads : threadCounts) {
+        ThreadPool pool(threads);
+        for (int round = 0; round < rounds; ++round) {
+            // Fewer items than workers leaves idle workers racing the next batch
+            size_t count = 1 + round % (threads + 2);
+            std::vector<std::atomic<int>> hits(count);
+            for (std::atomic<int>& hit : hits) {
+                hit = 0;
+            }
+            std::function<void(size_t, unsigned)> task = [&hits, &batch, &lateTasks, round](size_t i, unsigned) {
+                if (batch.load() != round) {
+                    ++lateTasks;
+                }
+                ++hits[i];
+            };
+            batch = round;
+            pool.parallelFor(count, task);
+            batch = -1;
+            for (const std::atomic<int>& hit : hits) {
+                if (hit != 1) {
+                    ++failures;
+                }
+            }
+        }
+        std::cout << threads << " workers: " << rounds << " batches" << std::endl;
+    }
+    failures += lateTasks;
+    std::cout << (failures == 0 ? "ok" : "FAILED") << ", " << failures - lateTasks << " bad indices, "
+              << lateTasks << " tasks outside their batch" << std::endl;
+    return failures == 0 ? 0 : 1;
+}